@@ -0,0 +1,80 @@
+#!/usr/bin/python
+
+import collections
+import sys,argparse
+import struct
+import json
+
+# Must match TMTraceHeader/TMTraceRecord in src/libTM/TMTrace.h
+TM_TRACE_MAGIC  = 0x544d5452
+HEADER_FMT      = '<IIII'
+RECORD_FMT      = '<QQQQIIIIiiHHI'
+RESULT_NAMES    = { 0: 'commit', 1: 'abort' }
+ABORT_TYPE_NAMES= { 0: 'conflict', 1: 'user', 2: 'syscall', 3: 'capacity', 4: 'nontm', 0xDEAD: 'none' }
+
+def read_records(f):
+    header_size = struct.calcsize(HEADER_FMT)
+    (magic, version, record_size, _) = struct.unpack(HEADER_FMT, f.read(header_size))
+    if magic != TM_TRACE_MAGIC:
+        raise ValueError('Not a TM trace file')
+    if record_size != struct.calcsize(RECORD_FMT):
+        raise ValueError('Unexpected record size %d (version %d)' % (record_size, version))
+    while True:
+        data = f.read(record_size)
+        if len(data) < record_size:
+            break
+        (utid, aborter_utid, begin_at, end_at, begin_pc, caddr, n_reads, n_writes,
+                pid, aborter_pid, result, abort_type, _) = struct.unpack(RECORD_FMT, data)
+        yield {
+            'type':         RESULT_NAMES.get(result, 'unknown'),
+            'utid':         utid,
+            'start_at':     begin_at,
+            'end_at':       end_at,
+            'pc':           '0x%x' % begin_pc,
+            'pid':          pid,
+            'rset_size':    n_reads,
+            'wset_size':    n_writes,
+            'abort_type':   ABORT_TYPE_NAMES.get(abort_type, str(abort_type)),
+            'aborter_pid':  aborter_pid,
+            'aborter_utid': aborter_utid if aborter_utid != 0xFFFFFFFFFFFFFFFF else -1,
+            'caddr':        '0x%x' % caddr,
+        }
+
+def make_instance(pid, attempts):
+    return {
+        'type':     'instances',
+        'pid':      pid,
+        'start_at': attempts[0]['start_at'],
+        'end_at':   attempts[-1]['end_at'],
+        'attempts': attempts,
+    }
+
+# Groups attempts of each thread into instances (all retries up to a commit) and
+# writes them as JSON lines, the format read by plot_timeline.py.
+def convert(infile, out):
+    pending = collections.defaultdict(list)
+    for attempt in read_records(infile):
+        pid = attempt['pid']
+        pending[pid].append(attempt)
+        if attempt['type'] == 'commit':
+            out.write(json.dumps(make_instance(pid, pending.pop(pid))) + '\n')
+    # Retries that never committed before the end of the run
+    for pid, attempts in pending.items():
+        out.write(json.dumps(make_instance(pid, attempts)) + '\n')
+
+def main():
+    parser = argparse.ArgumentParser('Converts binary TM trace into attempts jsonl file')
+    parser.add_argument('-i', '--infile', required=True)
+    parser.add_argument('-o', '--outfile')
+
+    args = parser.parse_args()
+
+    with open(args.infile, 'rb') as f:
+        if args.outfile:
+            with open(args.outfile, 'w') as out:
+                convert(f, out)
+        else:
+            convert(f, sys.stdout)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#include <string>
+#include "nanassert.h"
+#include "SescConf.h"
+#include "TMState.h"
+#include "ContentionManager.h"
+
+using namespace std;
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Factory function for all contention managers. Use different concrete classes
+// depending on SescConf
+/////////////////////////////////////////////////////////////////////////////////////////
+ContentionManager *ContentionManager::create(size_t nThreads) {
+    ContentionManager* newCM;
+
+    string method = "RequesterWins";
+    if(SescConf->checkCharPtr("TransactionalMemory","contentionManager")) {
+        method = SescConf->getCharPtr("TransactionalMemory","contentionManager");
+    }
+
+    if(method == "RequesterWins") {
+        newCM = new RequesterWinsCM(nThreads);
+    } else if(method == "RequesterStalls") {
+        newCM = new RequesterStallsCM(nThreads);
+    } else if(method == "Timestamp") {
+        newCM = new TimestampCM(nThreads);
+    } else if(method == "Karma") {
+        newCM = new KarmaCM(nThreads);
+    } else {
+        MSG("unknown contention manager %s, using RequesterWins", method.c_str());
+        newCM = new RequesterWinsCM(nThreads);
+    }
+
+    return newCM;
+}
+
+ContentionManager::ContentionManager(const char* cmName, size_t nThreads):
+        name(cmName),
+        nacks(nThreads, 0) {
+    if(SescConf->checkInt("TransactionalMemory","nackRetryStallCycles")) {
+        nackRetryStallCycles = SescConf->getInt("TransactionalMemory","nackRetryStallCycles");
+    } else {
+        nackRetryStallCycles = 20;
+    }
+    if(SescConf->checkInt("TransactionalMemory","maxNacks")) {
+        maxNacks = SescConf->getInt("TransactionalMemory","maxNacks");
+    } else {
+        maxNacks = 1000;
+    }
+}
+
+///
+// Apply the policy, but never NACK a requester forever: after maxNacks consecutive
+// NACKs it aborts itself, which also breaks any cycle of waiting transactions.
+CMDecision ContentionManager::resolve(Pid_t requester, const std::set<Pid_t>& others) {
+    CMDecision decision = decide(requester, others);
+
+    if(decision == CM_NACK_REQUESTER) {
+        nacks.at(requester) += 1;
+        if(nacks.at(requester) > maxNacks) {
+            nacks.at(requester) = 0;
+            decision = CM_ABORT_REQUESTER;
+        }
+    }
+    return decision;
+}
+
+TimestampCM::TimestampCM(size_t nThreads):
+        ContentionManager("Timestamp", nThreads),
+        firstUtids(nThreads, INVALID_UTID) {
+}
+void TimestampCM::beginTrans(Pid_t pid, uint64_t utid) {
+    if(firstUtids.at(pid) == INVALID_UTID) {
+        firstUtids.at(pid) = utid;
+    }
+}
+void TimestampCM::completeTrans(Pid_t pid) {
+    ContentionManager::completeTrans(pid);
+    firstUtids.at(pid) = INVALID_UTID;
+}
+CMDecision TimestampCM::decide(Pid_t requester, const std::set<Pid_t>& others) {
+    uint64_t myAge = firstUtids.at(requester);
+    for(Pid_t other: others) {
+        if(firstUtids.at(other) < myAge) {
+            return CM_NACK_REQUESTER;
+        }
+    }
+    return CM_ABORT_OTHERS;
+}
+
+KarmaCM::KarmaCM(size_t nThreads):
+        ContentionManager("Karma", nThreads),
+        karma(nThreads, 0) {
+}
+void KarmaCM::access(Pid_t pid) {
+    ContentionManager::access(pid);
+    karma.at(pid) += 1;
+}
+void KarmaCM::completeTrans(Pid_t pid) {
+    ContentionManager::completeTrans(pid);
+    karma.at(pid) = 0;
+}
+CMDecision KarmaCM::decide(Pid_t requester, const std::set<Pid_t>& others) {
+    uint64_t myKarma = karma.at(requester);
+    for(Pid_t other: others) {
+        if(karma.at(other) > myKarma) {
+            // Waiting earns karma, so the requester eventually wins
+            karma.at(requester) += 1;
+            return CM_NACK_REQUESTER;
+        }
+    }
+    return CM_ABORT_OTHERS;
+}
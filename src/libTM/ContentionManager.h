@@ -0,0 +1,100 @@
+#ifndef CONTENTION_MANAGER_H
+#define CONTENTION_MANAGER_H
+
+#include <set>
+#include <vector>
+#include "Snippets.h"
+
+/// Outcome of a conflict between a transactional requester and other transactions
+enum CMDecision {
+    CM_ABORT_OTHERS,        // Requester proceeds, conflicting transactions abort
+    CM_NACK_REQUESTER,      // Requester is NACKed and retries the access later
+    CM_ABORT_REQUESTER,     // Requester aborts itself
+};
+
+///
+// Decides who wins a transactional data conflict. Policies keep per-thread
+// state that lives across retries of the same atomic region, so it is only
+// reset when the region completes (commit or fallback).
+class ContentionManager {
+public:
+    virtual ~ContentionManager() { }
+
+    // Factory method
+    static ContentionManager *create(size_t nThreads);
+
+    CMDecision resolve(Pid_t requester, const std::set<Pid_t>& others);
+
+    // Notifications from HTMManager
+    virtual void beginTrans(Pid_t pid, uint64_t utid) { }
+    virtual void access(Pid_t pid) { nacks.at(pid) = 0; }
+    virtual void completeTrans(Pid_t pid) { nacks.at(pid) = 0; }
+
+    uint32_t getNackRetryStallCycles() const { return nackRetryStallCycles; }
+    const char* getName() const { return name; }
+protected:
+    ContentionManager(const char* cmName, size_t nThreads);
+
+    // The policy itself
+    virtual CMDecision decide(Pid_t requester, const std::set<Pid_t>& others) = 0;
+
+    const char*     name;
+    // Cycles to stall before retrying a NACKed access
+    uint32_t        nackRetryStallCycles;
+    // Consecutive NACKs after which the requester gives up and aborts
+    uint32_t        maxNacks;
+    // Consecutive NACKs received by each thread
+    std::vector<uint32_t> nacks;
+};
+
+///
+// Requester always wins (the original TSX behavior)
+class RequesterWinsCM: public ContentionManager {
+public:
+    RequesterWinsCM(size_t nThreads): ContentionManager("RequesterWins", nThreads) { }
+protected:
+    virtual CMDecision decide(Pid_t requester, const std::set<Pid_t>& others) {
+        return CM_ABORT_OTHERS;
+    }
+};
+
+///
+// Requester is NACKed and retries until the conflicting transactions finish
+class RequesterStallsCM: public ContentionManager {
+public:
+    RequesterStallsCM(size_t nThreads): ContentionManager("RequesterStalls", nThreads) { }
+protected:
+    virtual CMDecision decide(Pid_t requester, const std::set<Pid_t>& others) {
+        return CM_NACK_REQUESTER;
+    }
+};
+
+///
+// The oldest atomic region wins; younger requesters wait. The age is the UTID
+// of the first attempt, so a region gets older with every retry.
+class TimestampCM: public ContentionManager {
+public:
+    TimestampCM(size_t nThreads);
+    virtual void beginTrans(Pid_t pid, uint64_t utid);
+    virtual void completeTrans(Pid_t pid);
+protected:
+    virtual CMDecision decide(Pid_t requester, const std::set<Pid_t>& others);
+
+    std::vector<uint64_t> firstUtids;
+};
+
+///
+// Karma: priority is the work done by the region (accesses over all its
+// attempts). A requester with less karma waits, and gains karma while waiting.
+class KarmaCM: public ContentionManager {
+public:
+    KarmaCM(size_t nThreads);
+    virtual void access(Pid_t pid);
+    virtual void completeTrans(Pid_t pid);
+protected:
+    virtual CMDecision decide(Pid_t requester, const std::set<Pid_t>& others);
+
+    std::vector<uint64_t> karma;
+};
+
+#endif
@@ -45,6 +45,8 @@ HTMManager::HTMManager(const char tmStyle[], int32_t procs, int32_t line):
         lineSize(line),
         numCommits("tm:numCommits"),
         numAborts("tm:numAborts"),
+        numNacks("tm:numNacks"),
+        numCMSelfAborts("tm:numCMSelfAborts"),
         abortTypes("tm:abortTypes"),
         userAbortArgs("tm:userAbortArgs"),
         fallbackArgHist("tm:fallbackArgHist") {
@@ -63,8 +65,26 @@ HTMManager::HTMManager(const char tmStyle[], int32_t procs, int32_t line):
         tmStates.push_back(TMStateEngine(pid));
         abortStates.push_back(TMAbortState(pid));
         utids.push_back(INVALID_UTID);
+        beginAts.push_back(0);
+        beginPCs.push_back(0);
     }
     rwSetManager.initialize(nThreads);
+    contentionManager = ContentionManager::create(nThreads);
+    MSG("Using %s contention manager", contentionManager->getName());
+
+    tmTrace = NULL;
+    conflictProfiler = NULL;
+    if(SescConf->checkInt("TransactionalMemory","conflictProfileTopN")) {
+        int topN = SescConf->getInt("TransactionalMemory","conflictProfileTopN");
+        if(topN > 0) {
+            conflictProfiler = new TMConflictProfiler(topN);
+        }
+    }
+    if(SescConf->checkCharPtr("TransactionalMemory","traceFile")) {
+        const char *traceFile = SescConf->getCharPtr("TransactionalMemory","traceFile");
+        MSG("Writing TM trace to %s", traceFile);
+        tmTrace = new TMTrace(traceFile);
+    }
 }
 ///
 // Entry point for TM begin operation. Check for nesting and then call the real begin.
@@ -79,6 +99,9 @@ TMBCStatus HTMManager::begin(InstDesc* inst, const ThreadContext* context, InstC
 
         tmStates[pid].begin();
         abortStates.at(pid).clear();
+        contentionManager->beginTrans(pid, utids.at(pid));
+        beginAts.at(pid) = globalClock;
+        beginPCs.at(pid) = context->getIAddr();
     }
     return status;
 }
@@ -99,10 +122,14 @@ TMBCStatus HTMManager::commit(InstDesc* inst, const ThreadContext* context, Inst
     if(status == TMBC_SUCCESS) {
         // Do the commit
         numCommits.inc();
+        if(tmTrace) {
+            traceAttempt(pid, TM_TRACE_COMMIT);
+        }
 
         tmStates.at(pid).clear();
         utids.at(pid) = INVALID_UTID;
         rwSetManager.clear(pid);
+        contentionManager->completeTrans(pid);
     }
     return status;
 }
@@ -127,6 +154,7 @@ TMRWStatus HTMManager::read(InstDesc* inst, const ThreadContext* context, VAddr
             fail("%d in invalid state to do tm.load: %d", pid, getTMState(pid));
         }
         rwSetManager.read(pid, caddr);
+        contentionManager->access(pid);
     }
     return status;
 }
@@ -152,6 +180,7 @@ TMRWStatus HTMManager::write(InstDesc* inst, const ThreadContext* context, VAddr
             fail("%d in invalid state to do tm.store: %d", pid, getTMState(pid));
         }
         rwSetManager.write(pid, caddr);
+        contentionManager->access(pid);
     }
     return status;
 }
@@ -222,6 +251,7 @@ void HTMManager::beginFallback(Pid_t pid, uint32_t arg) {
 }
 void HTMManager::completeFallback(Pid_t pid) {
     fallbackArg.erase(pid);
+    contentionManager->completeTrans(pid);
 }
 
 void HTMManager::markTransAborted(Pid_t victimPid, Pid_t aborterPid, VAddr caddr, TMAbortType_e abortType) {
@@ -230,9 +260,96 @@ void HTMManager::markTransAborted(Pid_t victimPid, Pid_t aborterPid, VAddr caddr
     if(getTMState(victimPid) != TMStateEngine::TM_ABORTING && getTMState(victimPid) != TMStateEngine::TM_MARKABORT) {
         tmStates.at(victimPid).markAbort();
         abortStates.at(victimPid).markAbort(aborterPid, aborterUtid, caddr, abortType);
+        if(tmTrace) {
+            traceAttempt(victimPid, TM_TRACE_ABORT);
+        }
+        if(conflictProfiler && caddr != 0) {
+            conflictProfiler->addConflict(caddr, abortType,
+                ThreadContext::getContext(aborterPid), ThreadContext::getContext(victimPid),
+                beginPCs.at(victimPid));
+        }
     } // Else victim is already aborting, so leave it alone
 }
 
+TMRWStatus HTMManager::resolveConflict(Pid_t pid, VAddr caddr, bool isWrite) {
+    PidSet others;
+    rwSetManager.getWriters(caddr, others);
+    if(isWrite) {
+        rwSetManager.getReaders(caddr, others);
+    }
+    others.erase(pid);
+
+    // Transactions that are already aborting do not get a say
+    for(PidSet::iterator i_other = others.begin(); i_other != others.end(); ) {
+        if(getTMState(*i_other) != TMStateEngine::TM_RUNNING) {
+            others.erase(i_other++);
+        } else {
+            ++i_other;
+        }
+    }
+    if(others.empty()) {
+        return TMRW_SUCCESS;
+    }
+
+    TMRWStatus status = TMRW_INVALID;
+    switch(contentionManager->resolve(pid, others)) {
+        case CM_ABORT_OTHERS:
+            status = TMRW_SUCCESS;
+            break;
+        case CM_NACK_REQUESTER:
+            numNacks.inc();
+            status = TMRW_NACKED;
+            break;
+        case CM_ABORT_REQUESTER:
+            numCMSelfAborts.inc();
+            markTransAborted(pid, *others.begin(), caddr, TM_ATYPE_DEFAULT);
+            status = TMRW_ABORT;
+            break;
+        default:
+            fail("Unknown contention manager decision");
+    }
+    return status;
+}
+
+void HTMManager::traceAttempt(Pid_t pid, TMTraceResult result) {
+    const TMAbortState& abortState = abortStates.at(pid);
+
+    TMTraceRecord rec;
+    rec.utid        = utids.at(pid);
+    rec.beginAt     = beginAts.at(pid);
+    rec.endAt       = globalClock;
+    rec.beginPC     = beginPCs.at(pid);
+    rec.numReads    = rwSetManager.getNumReads(pid);
+    rec.numWrites   = rwSetManager.getNumWrites(pid);
+    rec.pid         = pid;
+    rec.result      = result;
+    rec.reserved    = 0;
+    if(result == TM_TRACE_ABORT) {
+        rec.aborterUtid     = abortState.getAborterUtid();
+        rec.aborterPid      = abortState.getAborterPid();
+        rec.conflictCAddr   = abortState.getAbortByAddr();
+        rec.abortType       = abortState.getAbortType();
+    } else {
+        rec.aborterUtid     = INVALID_UTID;
+        rec.aborterPid      = INVALID_PID;
+        rec.conflictCAddr   = 0;
+        rec.abortType       = TM_ATYPE_INVALID;
+    }
+    tmTrace->add(rec);
+}
+
+void HTMManager::report(const char *str) {
+    if(conflictProfiler) {
+        conflictProfiler->report(str);
+    }
+}
+
+void HTMManager::finish() {
+    if(tmTrace) {
+        tmTrace->close();
+    }
+}
+
 void HTMManager::markTransAborted(std::set<Pid_t>& aborted, Pid_t aborterPid, VAddr caddr, TMAbortType_e abortType) {
 	set<Pid_t>::iterator i_aborted;
     for(i_aborted = aborted.begin(); i_aborted != aborted.end(); ++i_aborted) {
@@ -11,6 +11,9 @@
 #include "libemul/InstDesc.h"
 #include "TMState.h"
 #include "RWSetManager.h"
+#include "TMTrace.h"
+#include "TMConflictProfiler.h"
+#include "ContentionManager.h"
 
 // Forward defs instead of ThreadContext.h
 class ThreadContext;
@@ -39,6 +42,11 @@ public:
     virtual void beginFallback(Pid_t pid, uint32_t arg);
     virtual void completeFallback(Pid_t pid);
 
+    // Print TM reports that are not GStats
+    void report(const char *str);
+    // Called at the end of simulation to flush any traces
+    void finish();
+
     // Query functions
     VAddr addrToCacheLine(VAddr raddr) {
         while(raddr % lineSize != 0) {
@@ -50,7 +58,7 @@ public:
     TMStateEngine::State_e getTMState(Pid_t pid)   const { return tmStates.at(pid).getState(); }
     uint64_t getUtid(Pid_t pid)     const { return utids.at(pid); }
 
-    virtual uint32_t getNackRetryStallCycles() const { return 0; }
+    uint32_t getNackRetryStallCycles() const { return contentionManager->getNackRetryStallCycles(); }
 
 protected:
     HTMManager(const char* tmStyle, int procs, int line);
@@ -59,6 +67,13 @@ protected:
     void markTransAborted(Pid_t victimPid, Pid_t aborterPid, VAddr caddr, TMAbortType_e abortType);
     void markTransAborted(std::set<Pid_t>& aborted, Pid_t aborterPid, VAddr caddr, TMAbortType_e abortType);
 
+    // Let the contention manager decide whether pid may access caddr. Returns
+    // TMRW_SUCCESS if the caller should go ahead and abort the conflicting transactions.
+    TMRWStatus resolveConflict(Pid_t pid, VAddr caddr, bool isWrite);
+
+    // Append the current attempt of pid to the TM trace
+    void traceAttempt(Pid_t pid, TMTraceResult result);
+
     // Interface for child classes to override and actually implement the TM OP
     virtual TMBCStatus myBegin(InstDesc* inst, const ThreadContext* context, InstContext* p_opStatus);
     virtual TMBCStatus myCommit(InstDesc* inst, const ThreadContext* context, InstContext* p_opStatus);
@@ -77,6 +92,7 @@ protected:
     int             lineSize;
 
     RWSetManager    rwSetManager;
+    ContentionManager* contentionManager;
     std::vector<struct TMStateEngine> tmStates;
     std::vector<TMAbortState>       abortStates;
     // The unique identifier for each tnx instance
@@ -84,10 +100,19 @@ protected:
     // Mono-increasing UTID
     static uint64_t nextUtid;
     std::map<Pid_t, uint32_t> fallbackArg;
+    // Cycle and PC of the current tm.begin for each thread
+    std::vector<Time_t>             beginAts;
+    std::vector<VAddr>              beginPCs;
+    // Per-attempt binary trace, NULL if not enabled
+    TMTrace         *tmTrace;
+    // Per-line/per-PC conflict aggregation, NULL if not enabled
+    TMConflictProfiler *conflictProfiler;
 
     // Statistics
     GStatsCntr      numCommits;
     GStatsCntr      numAborts;
+    GStatsCntr      numNacks;
+    GStatsCntr      numCMSelfAborts;
     GStatsHist      abortTypes;
     GStatsHist      userAbortArgs;
     GStatsHist      fallbackArgHist;
@@ -134,6 +134,11 @@ TMRWStatus IdealTSXManager::TMRead(InstDesc* inst, const ThreadContext* context,
     Cache* cache= getCache(pid);
 	VAddr caddr = addrToCacheLine(raddr);
 
+    TMRWStatus cmStatus = resolveConflict(pid, caddr, false);
+    if(cmStatus != TMRW_SUCCESS) {
+        return cmStatus;
+    }
+
     abortTMWriters(pid, caddr, true);
 
     // Do cache hit/miss stats
@@ -172,6 +177,11 @@ TMRWStatus IdealTSXManager::TMWrite(InstDesc* inst, const ThreadContext* context
     Cache* cache= getCache(pid);
 	VAddr caddr = addrToCacheLine(raddr);
 
+    TMRWStatus cmStatus = resolveConflict(pid, caddr, true);
+    if(cmStatus != TMRW_SUCCESS) {
+        return cmStatus;
+    }
+
     abortTMSharers(pid, caddr, true);
 
     // Do cache hit/miss stats
@@ -262,9 +272,13 @@ TMBCStatus IdealTSXManager::myCommit(InstDesc* inst, const ThreadContext* contex
     // On commit, we clear all transactional bits, but otherwise leave lines alone
     Cache* cache = getCache(pid);
 
-    LineTMComparator tmCmp;
+    // Only visit lines in this transaction's footprint
+    std::vector<VAddr> caddrs;
+    rwSetManager.getAccessedLines(pid, caddrs);
+
+    LineTMAccessedByComparator tmCmp(pid);
     std::vector<Line*> lines;
-    cache->collectLines(lines, tmCmp);
+    cache->collectLines(lines, caddrs, tmCmp);
 
     for(Line* line: lines) {
         line->clearTransactional(pid);
@@ -278,9 +292,13 @@ void IdealTSXManager::myStartAborting(InstDesc* inst, const ThreadContext* conte
     Pid_t pid   = context->getPid();
     Cache* cache = getCache(pid);
 
-    LineTMComparator tmCmp;
+    // Only visit lines in this transaction's footprint
+    std::vector<VAddr> caddrs;
+    rwSetManager.getAccessedLines(pid, caddrs);
+
+    LineTMAccessedByComparator tmCmp(pid);
     std::vector<Line*> lines;
-    cache->collectLines(lines, tmCmp);
+    cache->collectLines(lines, caddrs, tmCmp);
 
     for(Line* line: lines) {
         if(line->isDirty() && line->getWriter() == pid) {
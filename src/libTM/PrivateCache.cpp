@@ -317,4 +317,14 @@ void CacheAssocTM::collectLines(std::vector<TMLine*>& lines, const LineComparato
     }
 }
 
-
+///
+// Collect the lines for the given cache line addresses that satisfy comp. Cost
+// is proportional to caddrs rather than to the cache size.
+void CacheAssocTM::collectLines(std::vector<TMLine*>& lines, const std::vector<VAddr>& caddrs, const LineComparator& comp) {
+    for(VAddr caddr: caddrs) {
+        TMLine* line = findLine(caddr);
+        if (line && comp(line)) {
+            lines.push_back(line);
+        }
+    }
+}
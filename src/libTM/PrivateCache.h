@@ -146,6 +146,7 @@ public:
     TMLine *findLine(VAddr addr);
     size_t countLines(VAddr addr, const LineComparator& comp) const;
     void collectLines(std::vector<TMLine*>& lines, const LineComparator& comp);
+    void collectLines(std::vector<TMLine*>& lines, const std::vector<VAddr>& caddrs, const LineComparator& comp);
 
     uint32_t  getTMLineSize() const   {
         return lineSize;
@@ -66,3 +66,15 @@ void RWSetManager::getWriters(VAddr caddr, std::set<Pid_t>& w) const {
         w.insert(i_line->second.begin(), i_line->second.end());
     }
 }
+void RWSetManager::getAccessedLines(Pid_t pid, std::vector<VAddr>& caddrs) const {
+    const std::set<VAddr>& myReads  = linesRead.at(pid);
+    const std::set<VAddr>& myWrites = linesWritten.at(pid);
+
+    caddrs.reserve(caddrs.size() + myReads.size() + myWrites.size());
+    caddrs.insert(caddrs.end(), myReads.begin(), myReads.end());
+    for(VAddr caddr: myWrites) {
+        if(myReads.find(caddr) == myReads.end()) {
+            caddrs.push_back(caddr);
+        }
+    }
+}
@@ -32,6 +32,8 @@ public:
     // Return set of threads that read/wrote to given caddr
     void getReaders(VAddr caddr, std::set<Pid_t>& r) const;
     void getWriters(VAddr caddr, std::set<Pid_t>& w) const;
+    // Return all lines read or written by pid
+    void getAccessedLines(Pid_t pid, std::vector<VAddr>& caddrs) const;
 private:
     std::vector<std::set<VAddr> >       linesRead;
     std::vector<std::set<VAddr> >       linesWritten;
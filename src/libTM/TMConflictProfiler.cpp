@@ -0,0 +1,88 @@
+#include <algorithm>
+#include "ReportGen.h"
+#include "libll/ThreadContext.h"
+#include "TMConflictProfiler.h"
+
+using namespace std;
+
+TMConflictProfiler::TMConflictProfiler(size_t n): topN(n), nConflicts(0) {
+}
+
+///
+// Count one site, resolving its function name the first time the PC is seen so
+// that address spaces of exited threads are never needed at report time.
+void TMConflictProfiler::addSite(SiteMap& sites, VAddr pc, const ThreadContext* context) {
+    SiteStats& site = sites[pc];
+    if(site.count == 0) {
+        AddressSpace* addrSpace = context->getAddressSpace();
+        VAddr funcAddr = addrSpace->getFuncAddr(pc);
+        if(funcAddr) {
+            site.funcName = addrSpace->getFuncName(funcAddr);
+        } else {
+            site.funcName = "?";
+        }
+    }
+    site.count++;
+}
+
+void TMConflictProfiler::addConflict(VAddr caddr, TMAbortType_e abortType,
+        const ThreadContext* aborter, const ThreadContext* victim, VAddr victimBeginPC) {
+    nConflicts++;
+
+    LineStats& line = lines[caddr];
+    line.count++;
+    if(abortType == TM_ATYPE_SETCONFLICT) {
+        line.nCapacity++;
+    } else if(abortType == TM_ATYPE_NONTM) {
+        line.nNonTM++;
+    }
+
+    addSite(conflictSites, aborter->getIAddr(), aborter);
+    addSite(victimSites, victimBeginPC, victim);
+}
+
+template<class Map>
+static void getTop(const Map& m, size_t n, vector<typename Map::const_iterator>& top) {
+    for(typename Map::const_iterator i = m.begin(); i != m.end(); ++i) {
+        top.push_back(i);
+    }
+    n = min(n, top.size());
+    partial_sort(top.begin(), top.begin() + n, top.end(),
+        [](typename Map::const_iterator a, typename Map::const_iterator b) {
+            if(a->second.count != b->second.count) {
+                return a->second.count > b->second.count;
+            }
+            return a->first < b->first;
+        });
+    top.resize(n);
+}
+
+void TMConflictProfiler::reportSites(const char *name, const SiteMap& sites) const {
+    vector<SiteMap::const_iterator> top;
+    getTop(sites, topN, top);
+    for(size_t i = 0; i < top.size(); i++) {
+        Report::field("tm:%s[%lu]=0x%lx:count=%llu:func=%s", name, i,
+                (unsigned long)top[i]->first,
+                (unsigned long long)top[i]->second.count,
+                top[i]->second.funcName.c_str());
+    }
+}
+
+void TMConflictProfiler::report(const char *str) const {
+    Report::field("BEGIN TMConflictProfiler::report %s", str);
+    Report::field("tm:profConflicts=%llu:uniqueLines=%lu",
+            (unsigned long long)nConflicts, (unsigned long)lines.size());
+
+    vector<LineMap::const_iterator> top;
+    getTop(lines, topN, top);
+    for(size_t i = 0; i < top.size(); i++) {
+        Report::field("tm:hotLine[%lu]=0x%lx:count=%llu:capacity=%llu:nonTM=%llu", i,
+                (unsigned long)top[i]->first,
+                (unsigned long long)top[i]->second.count,
+                (unsigned long long)top[i]->second.nCapacity,
+                (unsigned long long)top[i]->second.nNonTM);
+    }
+    reportSites("hotConflictPC", conflictSites);
+    reportSites("hotVictimBeginPC", victimSites);
+    Report::field("END TMConflictProfiler::report %s", str);
+}
@@ -0,0 +1,55 @@
+#ifndef TM_CONFLICT_PROFILER_H
+#define TM_CONFLICT_PROFILER_H
+
+#include <string>
+#include <vector>
+#include "estl.h"
+#include "Snippets.h"
+#include "libemul/Addressing.h"
+#include "TMState.h"
+
+// Forward defs instead of ThreadContext.h
+class ThreadContext;
+
+///
+// Aggregates conflict aborts per cache line and per static code site (the PC
+// of the conflicting access and the tm.begin PC of the victim), and reports
+// the top-N of each at the end of the run.
+class TMConflictProfiler {
+public:
+    TMConflictProfiler(size_t topN);
+
+    void addConflict(VAddr caddr, TMAbortType_e abortType,
+            const ThreadContext* aborter, const ThreadContext* victim, VAddr victimBeginPC);
+    void report(const char *str) const;
+private:
+    struct SiteStats {
+        SiteStats(): count(0) {}
+        uint64_t    count;
+        std::string funcName;
+    };
+    typedef HASH_MAP<VAddr, SiteStats> SiteMap;
+
+    struct LineStats {
+        LineStats(): count(0), nCapacity(0), nNonTM(0) {}
+        uint64_t    count;
+        uint64_t    nCapacity;
+        uint64_t    nNonTM;
+    };
+    typedef HASH_MAP<VAddr, LineStats> LineMap;
+
+    static void addSite(SiteMap& sites, VAddr pc, const ThreadContext* context);
+    void reportSites(const char *name, const SiteMap& sites) const;
+
+    // Number of entries in each top-N list
+    size_t      topN;
+    uint64_t    nConflicts;
+
+    LineMap     lines;
+    // PC of the access that caused the abort
+    SiteMap     conflictSites;
+    // PC of the tm.begin of the aborted transaction
+    SiteMap     victimSites;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#include "TMTrace.h"
+
+TMTrace::TMTrace(const char *fname): writer(fname) {
+    TMTraceHeader header;
+    header.magic      = TM_TRACE_MAGIC;
+    header.version    = TM_TRACE_VERSION;
+    header.recordSize = sizeof(TMTraceRecord);
+    header.reserved   = 0;
+
+    writer.write(&header, sizeof(header));
+}
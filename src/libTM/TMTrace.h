@@ -0,0 +1,59 @@
+#ifndef TM_TRACE_H
+#define TM_TRACE_H
+
+#include <stdint.h>
+#include "AsyncFileWriter.h"
+
+// Magic number and version of the binary TM trace file header
+static const uint32_t TM_TRACE_MAGIC   = 0x544d5452; // "TMTR"
+static const uint32_t TM_TRACE_VERSION = 1;
+
+/// Outcome of one transaction attempt
+enum TMTraceResult {
+    TM_TRACE_COMMIT     = 0,
+    TM_TRACE_ABORT      = 1,
+};
+
+///
+// One transaction attempt. Written as-is to the trace file, so the layout is
+// fixed-width and padded to 64 bytes; scripts/tmtrace2json.py must be kept in sync.
+struct TMTraceRecord {
+    uint64_t    utid;           // UTID of this attempt
+    uint64_t    aborterUtid;    // UTID of the aborter (INVALID_UTID if none)
+    uint64_t    beginAt;        // globalClock at tm.begin
+    uint64_t    endAt;          // globalClock at commit or when marked aborted
+    uint32_t    beginPC;        // PC of the tm.begin
+    uint32_t    conflictCAddr;  // Conflicting cache line (0 if not a data conflict)
+    uint32_t    numReads;       // Read set size in cache lines
+    uint32_t    numWrites;      // Write set size in cache lines
+    int32_t     pid;
+    int32_t     aborterPid;
+    uint16_t    result;         // TMTraceResult
+    uint16_t    abortType;      // TMAbortType_e, truncated
+    uint32_t    reserved;
+};
+
+struct TMTraceHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    recordSize;
+    uint32_t    reserved;
+};
+
+///
+// Log of every transaction attempt in binary format, written by a background
+// thread so that tracing long runs does not stall the simulator.
+class TMTrace {
+public:
+    TMTrace(const char *fname);
+    ~TMTrace() { close(); }
+
+    void add(const TMTraceRecord& rec) {
+        writer.write(&rec, sizeof(rec));
+    }
+    void close() { writer.close(); }
+private:
+    AsyncFileWriter writer;
+};
+
+#endif
@@ -24,6 +24,7 @@ TSXManager::TSXManager(const char tmStyle[], int32_t nCores, int32_t line):
     for(int coreId = 0; coreId < nCores; coreId++) {
         caches.push_back(new CacheAssocTM(totalSize, assoc, lineSize, 1));
     }
+    overflow.resize(nThreads);
 }
 
 ///
@@ -195,6 +196,11 @@ TMRWStatus TSXManager::TMRead(InstDesc* inst, const ThreadContext* context, VAdd
     Cache* cache= getCache(pid);
 	VAddr caddr = addrToCacheLine(raddr);
 
+    TMRWStatus cmStatus = resolveConflict(pid, caddr, false);
+    if(cmStatus != TMRW_SUCCESS) {
+        return cmStatus;
+    }
+
     std::set<Cache*> except;
     abortTMWriters(pid, caddr, true, except);
 
@@ -235,6 +241,11 @@ TMRWStatus TSXManager::TMWrite(InstDesc* inst, const ThreadContext* context, VAd
     Cache* cache= getCache(pid);
 	VAddr caddr = addrToCacheLine(raddr);
 
+    TMRWStatus cmStatus = resolveConflict(pid, caddr, true);
+    if(cmStatus != TMRW_SUCCESS) {
+        return cmStatus;
+    }
+
     std::set<Cache*> except;
     abortTMSharers(pid, caddr, true, except);
 
@@ -332,9 +343,13 @@ TMBCStatus TSXManager::myCommit(InstDesc* inst, const ThreadContext* context, In
     // On commit, we clear all transactional bits, but otherwise leave lines alone
     Cache* cache = getCache(pid);
 
-    LineTMComparator tmCmp;
+    // Only visit lines in this transaction's footprint
+    std::vector<VAddr> caddrs;
+    rwSetManager.getAccessedLines(pid, caddrs);
+
+    LineTMAccessedByComparator tmCmp(pid);
     std::vector<Line*> lines;
-    cache->collectLines(lines, tmCmp);
+    cache->collectLines(lines, caddrs, tmCmp);
 
     for(Line* line: lines) {
         line->clearTransactional(pid);
@@ -349,9 +364,13 @@ void TSXManager::myStartAborting(InstDesc* inst, const ThreadContext* context, I
     Pid_t pid   = context->getPid();
     Cache* cache = getCache(pid);
 
-    LineTMComparator tmCmp;
+    // Only visit lines in this transaction's footprint
+    std::vector<VAddr> caddrs;
+    rwSetManager.getAccessedLines(pid, caddrs);
+
+    LineTMAccessedByComparator tmCmp(pid);
     std::vector<Line*> lines;
-    cache->collectLines(lines, tmCmp);
+    cache->collectLines(lines, caddrs, tmCmp);
 
     for(Line* line: lines) {
         if(line->isDirty() && line->getWriter() == pid) {
@@ -39,7 +39,8 @@ protected:
 
     // State member variables
     std::vector<Cache*>         caches;
-    std::map<Pid_t, std::set<VAddr> >   overflow;
+    // Clean transactional lines evicted from the cache, indexed by pid
+    std::vector<std::set<VAddr> >       overflow;
 };
 
 #endif
@@ -180,6 +180,12 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
     _output_buffer.resize(_outputs);
     _credit_buffer.resize(_inputs);
 
+    // Per-cycle staging, indexed by input port
+    _in_queue_flits.resize(_inputs, NULL);
+    _in_queue_flit_count = 0;
+    _out_queue_credits.resize(_inputs, NULL);
+    _out_queue_credit_count = 0;
+
     // Switch configuration (when held for multiple cycles)
     _hold_switch_for_packet = (config.GetInt("hold_switch_for_packet") > 0);
     _switch_hold_in.resize(_inputs*_input_speedup, -1);
@@ -342,7 +348,9 @@ bool IQRouter::_ReceiveFlits( )
                            << " from channel at input " << input
                            << "." << endl;
             }
-            _in_queue_flits.insert(make_pair(input, f));
+            assert(_in_queue_flits[input] == NULL);
+            _in_queue_flits[input] = f;
+            ++_in_queue_flit_count;
             activity = true;
         }
     }
@@ -372,16 +380,16 @@ bool IQRouter::_ReceiveCredits( )
 
 void IQRouter::_InputQueuing( )
 {
-    for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-            iter != _in_queue_flits.end();
-            ++iter)
+    for(int input = 0; (input < _inputs) && (_in_queue_flit_count > 0); ++input)
     {
 
-        int const input = iter->first;
-        assert((input >= 0) && (input < _inputs));
-
-        Flit * const f = iter->second;
-        assert(f);
+        Flit * const f = _in_queue_flits[input];
+        if(!f)
+        {
+            continue;
+        }
+        _in_queue_flits[input] = NULL;
+        --_in_queue_flit_count;
 
         int const vc = f->vc;
         assert((vc >= 0) && (vc < _vcs));
@@ -469,7 +477,7 @@ void IQRouter::_InputQueuing( )
             }
         }
     }
-    _in_queue_flits.clear();
+    assert(_in_queue_flit_count == 0);
 
     while(!_proc_credits.empty())
     {
@@ -1264,11 +1272,12 @@ void IQRouter::_SWHoldUpdate( )
 
             _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
-            if(_out_queue_credits.count(input) == 0)
+            if(_out_queue_credits[input] == NULL)
             {
-                _out_queue_credits.insert(make_pair(input, Credit::New()));
+                _out_queue_credits[input] = Credit::New();
+                ++_out_queue_credit_count;
             }
-            _out_queue_credits.find(input)->second->vc.insert(vc);
+            _out_queue_credits[input]->vc.insert(vc);
 
             if(cur_buf->Empty(vc))
             {
@@ -2332,11 +2341,12 @@ void IQRouter::_SWAllocUpdate( )
 
             _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
-            if(_out_queue_credits.count(input) == 0)
+            if(_out_queue_credits[input] == NULL)
             {
-                _out_queue_credits.insert(make_pair(input, Credit::New()));
+                _out_queue_credits[input] = Credit::New();
+                ++_out_queue_credit_count;
             }
-            _out_queue_credits.find(input)->second->vc.insert(vc);
+            _out_queue_credits[input]->vc.insert(vc);
 
             if(cur_buf->Empty(vc))
             {
@@ -2553,21 +2563,21 @@ void IQRouter::_SwitchUpdate( )
 
 void IQRouter::_OutputQueuing( )
 {
-    for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-            iter != _out_queue_credits.end();
-            ++iter)
+    for(int input = 0; (input < _inputs) && (_out_queue_credit_count > 0); ++input)
     {
 
-        int const input = iter->first;
-        assert((input >= 0) && (input < _inputs));
-
-        Credit * const c = iter->second;
-        assert(c);
+        Credit * const c = _out_queue_credits[input];
+        if(!c)
+        {
+            continue;
+        }
         assert(!c->vc.empty());
 
         _credit_buffer[input].push(c);
+        _out_queue_credits[input] = NULL;
+        --_out_queue_credit_count;
     }
-    _out_queue_credits.clear();
+    assert(_out_queue_credit_count == 0);
 }
 
 //------------------------------------------------------------------------------
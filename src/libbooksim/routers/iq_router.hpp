@@ -68,7 +68,9 @@ class IQRouter : public Router
     int _vc_alloc_delay;
     int _sw_alloc_delay;
 
-    map<int, Flit *> _in_queue_flits;
+    // Indexed by input; NULL when no flit arrived this cycle
+    vector<Flit *> _in_queue_flits;
+    int _in_queue_flit_count;
 
     deque<pair<BTime_t, pair<Credit *, int> > > _proc_credits;
 
@@ -79,7 +81,9 @@ class IQRouter : public Router
 
     deque<pair<BTime_t, pair<Flit *, pair<int, int> > > > _crossbar_flits;
 
-    map<int, Credit *> _out_queue_credits;
+    // Indexed by input; NULL when no credit is pending this cycle
+    vector<Credit *> _out_queue_credits;
+    int _out_queue_credit_count;
 
     vector<Buffer *> _buf;
     vector<BufferState *> _next_buf;
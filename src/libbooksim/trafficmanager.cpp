@@ -356,10 +356,17 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 		_packetBuffer[s].resize(_classes);
     }
 
+    _total_in_flight_count.resize(_classes, 0);
+    _measured_in_flight_count.resize(_classes, 0);
+    _total_in_flight_ctime.resize(_classes, 0);
+#ifdef TRACK_IN_FLIGHT_FLITS
     _total_in_flight_flits.resize(_classes);
     _measured_in_flight_flits.resize(_classes);
+#endif
     _retired_packets.resize(_classes);
 
+    _eject_flits.resize(_subnets, vector<Flit *>(_nodes, (Flit *)NULL));
+
     _packet_seq_no.resize(_nodes);
     //_repliesPending.resize(_nodes);
     _requestsOutstanding.resize(_nodes);
@@ -773,13 +780,22 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
 {
     _deadlock_timer = 0;
 
+    assert(_total_in_flight_count[f->cl] > 0);
+    --_total_in_flight_count[f->cl];
+    _total_in_flight_ctime[f->cl] -= f->ctime;
+#ifdef TRACK_IN_FLIGHT_FLITS
     assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
     _total_in_flight_flits[f->cl].erase(f->id);
+#endif
 
     if(f->record)
     {
+        assert(_measured_in_flight_count[f->cl] > 0);
+        --_measured_in_flight_count[f->cl];
+#ifdef TRACK_IN_FLIGHT_FLITS
         assert(_measured_in_flight_flits[f->cl].count(f->id) > 0);
         _measured_in_flight_flits[f->cl].erase(f->id);
+#endif
     }
 
     if ( f->watch )
@@ -981,10 +997,17 @@ void TrafficManager::_GenerateSESCPacket( int source, int cl, SESCPacket *p, BTi
 		// JJ
 		f->SESCPkt = p->GetSESCPkt();
 
+        ++_total_in_flight_count[f->cl];
+        _total_in_flight_ctime[f->cl] += f->ctime;
+#ifdef TRACK_IN_FLIGHT_FLITS
         _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+#endif
         if(record)
         {
+            ++_measured_in_flight_count[f->cl];
+#ifdef TRACK_IN_FLIGHT_FLITS
             _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+#endif
         }
 
         if(gTrace)
@@ -1061,7 +1084,7 @@ bool TrafficManager::_PacketsOutstanding( ) const
     {
         if ( _measure_stats[c] )
         {
-            if ( _measured_in_flight_flits[c].empty() )
+            if ( _measured_in_flight_count[c] == 0 )
             {
 
                 for ( int s = 0; s < _nodes; ++s )
@@ -1079,7 +1102,7 @@ bool TrafficManager::_PacketsOutstanding( ) const
             else
             {
 #ifdef DEBUG_DRAIN
-                cout << "in flight = " << _measured_in_flight_flits[c].size() << endl;
+                cout << "in flight = " << _measured_in_flight_count[c] << endl;
 #endif
                 return true;
             }
@@ -1187,34 +1210,37 @@ void TrafficManager::_DisplayRemaining( ostream & os ) const
     for(int c = 0; c < _classes; ++c)
     {
 
-        map<BId_t, Flit *>::const_iterator iter;
-        int i;
-
         os << "Class " << c << ":" << endl;
 
         os << "Remaining flits: ";
+#ifdef TRACK_IN_FLIGHT_FLITS
+        map<BId_t, Flit *>::const_iterator iter;
+        int i;
         for ( iter = _total_in_flight_flits[c].begin( ), i = 0;
                 ( iter != _total_in_flight_flits[c].end( ) ) && ( i < 10 );
                 iter++, i++ )
         {
             os << iter->first << " ";
         }
-        if(_total_in_flight_flits[c].size() > 10)
+        if(_total_in_flight_count[c] > 10)
             os << "[...] ";
+#endif
 
-        os << "(" << _total_in_flight_flits[c].size() << " flits)" << endl;
+        os << "(" << _total_in_flight_count[c] << " flits)" << endl;
 
         os << "Measured flits: ";
+#ifdef TRACK_IN_FLIGHT_FLITS
         for ( iter = _measured_in_flight_flits[c].begin( ), i = 0;
                 ( iter != _measured_in_flight_flits[c].end( ) ) && ( i < 10 );
                 iter++, i++ )
         {
             os << iter->first << " ";
         }
-        if(_measured_in_flight_flits[c].size() > 10)
+        if(_measured_in_flight_count[c] > 10)
             os << "[...] ";
+#endif
 
-        os << "(" << _measured_in_flight_flits[c].size() << " flits)" << endl;
+        os << "(" << _measured_in_flight_count[c] << " flits)" << endl;
 
     }
 }
@@ -1290,14 +1316,9 @@ bool TrafficManager::Checkpoint()
 		double latency = (double)_plat_stats[c]->Sum();
 		double count = (double)_plat_stats[c]->NumSamples();
 
-		map<BId_t, Flit *>::const_iterator iter;
-		for(iter = _total_in_flight_flits[c].begin();
-				iter != _total_in_flight_flits[c].end();
-				iter++)
-		{
-			latency += (double)(_time - iter->second->ctime);
-			count++;
-		}
+		// Sum of (_time - ctime) over all in-flight flits
+		latency += (double)(_time * _total_in_flight_count[c] - _total_in_flight_ctime[c]);
+		count += _total_in_flight_count[c];
 
 		if((lat_exc_class < 0) &&
 				(_latency_thres[c] >= 0.0) &&
@@ -1340,7 +1361,7 @@ void TrafficManager::Finish()
 	bool packets_left = false;
 	for(int c = 0; c < _classes; ++c)
 	{
-		packets_left |= !_total_in_flight_flits[c].empty();
+		packets_left |= (_total_in_flight_count[c] > 0);
 	}
 	
 	*_os_out << "Draining remaining packets ..." << endl;
@@ -1355,7 +1376,7 @@ void TrafficManager::Finish()
 		packets_left = false;
 		for(int c = 0; c < _classes; ++c)
 		{
-			packets_left |= !_total_in_flight_flits[c].empty();
+			packets_left |= (_total_in_flight_count[c] > 0);
 		}
 	}
 	//wait until all the credits are drained as well
@@ -1393,7 +1414,7 @@ bool TrafficManager::IsFlitInFlight() const
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c)
     {
-        flits_in_flight |= !_total_in_flight_flits[c].empty();
+        flits_in_flight |= (_total_in_flight_count[c] > 0);
     }
 	return flits_in_flight;
 }
@@ -1404,7 +1425,7 @@ void TrafficManager::CallEveryCycle()
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c)
     {
-        flits_in_flight |= !_total_in_flight_flits[c].empty();
+        flits_in_flight |= (_total_in_flight_count[c] > 0);
     }
     if(flits_in_flight && (_deadlock_timer++ >= _deadlock_warn_timeout))
     {
@@ -1412,8 +1433,6 @@ void TrafficManager::CallEveryCycle()
         cout << "WARNING: Possible network deadlock.\n";
     }
 
-    vector<map<int, Flit *> > flits(_subnets);
-
     for ( int subnet = 0; subnet < _subnets; ++subnet )
     {
         for ( int n = 0; n < _nodes; ++n )
@@ -1430,7 +1449,7 @@ void TrafficManager::CallEveryCycle()
                                << " from VC " << f->vc
                                << "." << endl;
                 }
-                flits[subnet].insert(make_pair(n, f));
+                _eject_flits[subnet][n] = f;
                 if((_sim_state == warming_up) || (_sim_state == running))
                 {
                     ++_accepted_flits[f->cl][n];
@@ -1744,10 +1763,10 @@ void TrafficManager::CallEveryCycle()
     {
         for(int n = 0; n < _nodes; ++n)
         {
-            map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-            if(iter != flits[subnet].end())
+            Flit * const f = _eject_flits[subnet][n];
+            if(f)
             {
-                Flit * const f = iter->second;
+                _eject_flits[subnet][n] = NULL;
 
                 f->atime = _time;
                 if(f->watch)
@@ -1769,7 +1788,6 @@ void TrafficManager::CallEveryCycle()
                 _RetireFlit(f, n);
             }
         }
-        flits[subnet].clear();
         _net[subnet]->Evaluate( );
         _net[subnet]->WriteOutputs( );
     }
@@ -2175,8 +2193,8 @@ void TrafficManager::DisplayStats(ostream & os) const
         os << "Average injected packet length = " << (double)sent_flits / (double)sent_packets << endl
              << "Average accepted packet length = " << (double)accepted_flits / (double)accepted_packets << endl;
 
-        os << "Total in-flight flits = " << _total_in_flight_flits[c].size()
-             << " (" << _measured_in_flight_flits[c].size() << " measured)"
+        os << "Total in-flight flits = " << _total_in_flight_count[c]
+             << " (" << _measured_in_flight_count[c] << " measured)"
              << endl;
 
 #ifdef TRACK_STALLS
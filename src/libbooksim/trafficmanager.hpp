@@ -120,9 +120,19 @@ protected:
     vector<vector<bool> > _qdrained;
     vector<vector<list<Flit *> > > _partial_packets;
 
+    // Per-class in-flight flit counters; the sum of creation times lets
+    // latency estimates include in-flight flits without walking them
+    vector<int> _total_in_flight_count;
+    vector<int> _measured_in_flight_count;
+    vector<BTime_t> _total_in_flight_ctime;
+#ifdef TRACK_IN_FLIGHT_FLITS
     vector<map<BId_t, Flit *> > _total_in_flight_flits;
     vector<map<BId_t, Flit *> > _measured_in_flight_flits;
+#endif
     vector<map<BId_t, Flit *> > _retired_packets;
+
+    // Flits ejected this cycle, indexed by [subnet][node]
+    vector<vector<Flit *> > _eject_flits;
     bool _empty_network;
 
     bool _hold_switch_for_packet;
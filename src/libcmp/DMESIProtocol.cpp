@@ -20,6 +20,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 */
 
 #include "DMESIProtocol.h"
+#include "SMPSliceCache.h"
 
 #if (defined RCHECK)
 #include "libmem/Cache.h"
@@ -280,6 +281,9 @@ void DMESIProtocol::doSendReadMiss(MemRequest *mreq)
     sreq->addDstNode(pCache->getHomeNodeID(addr));
     sreq->msgOwner = pCache;
 
+    if(SMPSliceCache::nucaLocalRead(sreq))
+        return;
+
     //printf("R\t%5d\t%10x\t%10x\t%5d\t%lld\n", pCache->getNodeID(), addr, pCache->calcTag(addr), pCache->getHomeNodeID(addr), globalClock);
 
     DEBUGPRINT("   [%s] read miss (%s) send to %d from %d on %x at %lld (0x%lx) (o: %p)\n", pCache->getSymbolicName(),
@@ -400,7 +404,7 @@ void DMESIProtocol::sendWriteMissAck(SMPMemRequest *sreq)
 
 void DMESIProtocol::sendInvalidateAck(SMPMemRequest *sreq)
 {
-    IJ(sreq->dstObj.find(pCache)!=sreq->dstObj.end());
+    IJ(sreq->dstObj.has(pCache));
     sreq->dstObj.erase(pCache);
 
 
@@ -51,7 +51,15 @@ extern unsigned long long lastFin;
 extern char* MemOperationStr[];
 
 SMPMemRequest::MESHSTRMAP SMPMemRequest::SMPMemReqStrMap;
-std::map<PAddr, int> SMPCache::dirMap;
+HomeNodeTable SMPCache::dirMap(NoHomeNode);
+int32_t SMPCache::homeBlockShift = -1;
+int32_t SMPCache::homeStrideNodes = 0;
+bool SMPCache::homeDynamic = false;
+uint16_t SMPCache::homeMigrateThreshold = 16;
+const char *SMPCache::homeProfileOut = NULL;
+static const HomeVote noVote = { NoHomeNode, 0 };
+HomeBlockTable<HomeVote> SMPCache::homeVotes(noVote);
+static const char HomeProfileMagic[8] = {'S','E','S','C','H','O','M','1'};
 
 const char* SMPCache::cohOutfile = NULL;
 	
@@ -162,6 +170,8 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
     nodeID = dms->getPID();
     maxNodeID = dms->getPPN();
 	maxNodeID_bit = log2i(maxNodeID);
+    if(maxNodeID > SMPNodeMask::MaxNodes)
+        fail("[SMPCache::%s] %d nodes, SMPMemRequest supports at most %d\n", name, maxNodeID, (int)SMPNodeMask::MaxNodes);
     //printf("%s nID: %d / %d\n",name, nodeID, maxNodeID);
 	nodeSelSht = 0;
 	if(SescConf->checkInt(section, "nodeSel")) {
@@ -185,6 +195,8 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
 
     outsReq = MSHR<PAddr,SMPCache>::create(outsReqName, mshrSection);
 
+    prefetcher = SMPPrefetcher::create(section, name, cache->getLineSize());
+
 #if 0
     if (mutExclBuffer == NULL)
         mutExclBuffer = MSHR<PAddr,SMPCache>::create("mutExclBuffer",
@@ -220,6 +232,30 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
 
         homeDirBlockSize = 0;
         homeDirBlockSize = SescConf->getInt(section, "homeDirBlockSize");
+
+        // All caches share one home map, so they must agree on its blocks
+        int32_t shift = cache->getLog2AddrLs() + homeDirBlockSize;
+        int32_t strideNodes = (homeDirType == HDT_STRIDE) ? maxNodeID : 0;
+        bool firstHome = (homeBlockShift == -1);
+        if(firstHome) {
+            homeBlockShift = shift;
+            homeStrideNodes = strideNodes;
+            homeDynamic = (homeDirType == HDT_DYNAMIC);
+        } else if(homeBlockShift != shift || homeStrideNodes != strideNodes
+                  || homeDynamic != (homeDirType == HDT_DYNAMIC)) {
+            fail("[SMPCache::%s] home placement differs from other caches\n", symbolicName);
+        }
+
+        if(homeDirType == HDT_DYNAMIC) {
+            if(SescConf->checkInt(section, "homeMigrateThreshold")) {
+                SescConf->isBetween(section, "homeMigrateThreshold", 1, 32767);
+                homeMigrateThreshold = SescConf->getInt(section, "homeMigrateThreshold");
+            }
+        }
+        if(homeDirType == HDT_PROFILE)
+            loadHomeProfile(SescConf->getCharPtr(section, "homeProfile"));
+        if(SescConf->checkCharPtr(section, "homeProfileOut") && homeProfileOut == NULL)
+            homeProfileOut = SescConf->getCharPtr(section, "homeProfileOut");
     }
  
 #ifdef SESC_ENERGY
@@ -270,6 +306,7 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
         SMPMemRequest::SMPMemReqStrMap[ExclusiveAck]=		   "ExclusiveAck";
         SMPMemRequest::SMPMemReqStrMap[UpgradeRequest]=		   "UpgradeRequest";
         SMPMemRequest::SMPMemReqStrMap[ExclusiveReplyInvND]=		   "ExclusiveReplyInvND";
+        SMPMemRequest::SMPMemReqStrMap[NucaDirUpdate]=		   "NucaDirUpdate";
         SMPMemRequest::SMPMemReqStrMap[WriteBackRequest]=	   "WriteBackRequest";
         SMPMemRequest::SMPMemReqStrMap[TokenBackRequest]=	   "TokenBackRequest";
         SMPMemRequest::SMPMemReqStrMap[WriteBackExAck]=		   "WriteBackExAck";
@@ -338,7 +375,7 @@ void SMPCache::PrintStat()
 
 SMPCache::~SMPCache()
 {
-    // do nothing
+    delete prefetcher;
 }
 
 Time_t SMPCache::getNextFreeCycle() const
@@ -430,7 +467,8 @@ void SMPCache::access(MemRequest *mreq)
 
     switch(mreq->getMemOperation()) {
     case MemRead:
-        l1ReadMiss.inc();
+        if(!mreq->isPrefetch())
+            l1ReadMiss.inc();
         read(mreq);
         break;
     case MemWrite: /*I(cache->findLine(mreq->getPAddr())); will be transformed
@@ -474,7 +512,8 @@ void SMPCache::read(MemRequest *mreq)
         // DEBUGPRINT("[%s] read half miss %x at %lld\n",getSymbolicName(), addr,  globalClock );
         outsReq->addEntry(addr, doReadCB::create(this, mreq),
                           doReadCB::create(this, mreq));
-        readHalfMiss.inc();
+        if(!mreq->isPrefetch())
+            readHalfMiss.inc();
         return;
     }
 
@@ -495,11 +534,17 @@ void SMPCache::doRead(MemRequest *mreq)
     //sdprint = true;
 
     if (l && l->canBeRead()) {
+        outsReq->retire(addr);
+        if(mreq->isPrefetch()) {
+            mreq->goUp(0);
+            return;
+        }
         readHit.inc();
 #ifdef SESC_ENERGY
         rdEnergy[0]->inc();
 #endif
-        outsReq->retire(addr);
+        if(prefetcher)
+            prefetcher->demandHit(addr);
         mreq->goUp(hitDelay);
         return;
     }
@@ -516,6 +561,11 @@ void SMPCache::doRead(MemRequest *mreq)
 
     GI(l, !l->isLocked());
 
+    if(mreq->isPrefetch()) {
+        sendRead(mreq);
+        return;
+    }
+
     readMiss.inc();
 
 #if (defined TRACK_MPKI)
@@ -542,6 +592,9 @@ void SMPCache::doRead(MemRequest *mreq)
     }
 #endif
 
+    if(prefetcher)
+        issuePrefetches(addr);
+
     sendRead(mreq);
 }
 
@@ -550,6 +603,38 @@ void SMPCache::sendRead(MemRequest* mreq)
     protocol->read(mreq);
 }
 
+// Prefetches travel as ordinary reads from this cache (coherent GetS at the
+// home slice) that nobody waits for. They are dropped rather than queued
+// when the line is present or pending, or when the MSHR is running out of
+// entries for demand misses.
+void SMPCache::issuePrefetches(PAddr addr)
+{
+    int32_t stride = prefetcher->learnMiss(addr);
+    if(stride == 0)
+        return;
+
+    PAddr pfAddr = addr & ~(cache->getLineSize() - 1);
+    int32_t nIssued = 0;
+    for(int32_t i = 0; i < prefetcher->getDegree(); i++) {
+        PAddr next = pfAddr + stride;
+        if((stride > 0) != (next > pfAddr) || next < 1024)
+            break; // wrapped around the address space
+        pfAddr = next;
+
+        if(cache->findLineNoEffect(pfAddr) || outsReq->hasEntry(pfAddr))
+            continue;
+        if(outsReq->getnFreeEntries() - nIssued <= prefetcher->getMSHRReserve()) {
+            prefetcher->throttled();
+            break;
+        }
+
+        CBMemRequest *r = CBMemRequest::create(1, this, MemRead, pfAddr, 0);
+        r->markPrefetch();
+        prefetcher->issued(pfAddr);
+        nIssued++;
+    }
+}
+
 void SMPCache::write(MemRequest *mreq)
 {
     PAddr addr = mreq->getPAddr();
@@ -1326,7 +1411,7 @@ void SMPCache::returnAccess(MemRequest *mreq)
         }
         break;
     case Invalidation:
-        if(sreq->dstObj.find(this)!=sreq->dstObj.end()) {
+        if(sreq->dstObj.has(this)) {
             DEBUGPRINT("   [%s] Received Invalidation message from %d for %x at %lld\n",
                        getSymbolicName(), sreq->getSrcNode(), sreq->getPAddr(), globalClock);
             protocol->invalidateHandler(sreq);
@@ -1513,7 +1598,7 @@ void SMPCache::returnAccess(MemRequest *mreq)
         }
 #endif
     } else if (meshOp == MeshInvRequest) {
-        if(sreq->dstObj.find(this)!=sreq->dstObj.end()) {
+        if(sreq->dstObj.has(this)) {
             protocol->invalidateHandler(sreq);
         }
     } else if (meshOp == MeshInvReply || meshOp == MeshInvDataReply) {
@@ -1642,6 +1727,7 @@ void SMPCache::sendInvDirUpdate(PAddr rpl_addr, PAddr new_addr, CallbackBase *cb
         //}
         sreq->newAddr = new_addr;
         sreq->invCB = cb;
+        sreq->writeBack = wb;
         sreq->addDstNode(getHomeNodeID(rpl_addr));
         sreq->msgOwner = this;
 
@@ -1788,6 +1874,9 @@ SMPCache::Line *SMPCache::allocateLine(PAddr addr, CallbackBase *cb,
             //		getSymbolicName(), rpl_addr, globalClock, addr);
         }
 
+        if(!wb)
+            SMPSliceCache::nucaVictim(nodeID, rpl_addr);
+
         l->changeStateTo(SMP_TRANS_INV);
 
         DEBUGPRINT("   [%s] INVALIDATE %x at %lld (for %x)\n",
@@ -1991,32 +2080,119 @@ int32_t SMPCache::getL2NodeID_stride(int32_t blockIndex) {
 }
 
 int32_t SMPCache::getL2NodeID_firstTouch(int32_t blockIndex) {
-    std::map<PAddr,int>::iterator it = dirMap.find (blockIndex);
-    if (it==dirMap.end()) {
-        dirMap.insert( std::pair<PAddr, int>(blockIndex, getNodeID()) );
-        return getNodeID();
-    }
-    else
-        return it->second;
+    int16_t &home = dirMap[blockIndex];
+    if (home == NoHomeNode)
+        home = getNodeID();
+    return home;
 }
 
 int32_t SMPCache::getL2NodeID_random(int32_t blockIndex) {
-    std::map<PAddr,int>::iterator it = dirMap.find (blockIndex);
-    if (it==dirMap.end()) {
-        int dst = rand() % getMaxNodeID();
-        dirMap.insert( std::pair<PAddr, int>(blockIndex, dst));
-        return dst;
-    }
-    else
-        return it->second;
+    int16_t &home = dirMap[blockIndex];
+    if (home == NoHomeNode)
+        home = rand() % getMaxNodeID();
+    return home;
 }
 
+// Blocks the profile does not cover are placed on first touch
 int32_t SMPCache::getL2NodeID_profile(int32_t blockIndex) {
-    fail("Not implemented yet\n");
+    return getL2NodeID_firstTouch(blockIndex);
 }
 
+// Blocks start at their first toucher; the directory slices move them
+// afterwards (see SMPSliceCache::checkHome)
 int32_t SMPCache::getL2NodeID_dynamic(int32_t blockIndex) {
-    fail("Not implemented yet\n");
+    return getL2NodeID_firstTouch(blockIndex);
+}
+
+int32_t SMPCache::voteHome(PAddr addr, int32_t node, int32_t home) {
+    HomeVote &v = homeVotes[addr >> homeBlockShift];
+    if(v.node == node) {
+        if(v.count < 0xFFFF)
+            v.count++;
+    } else if(v.count == 0) {
+        v.node  = node;
+        v.count = 1;
+    } else {
+        v.count--;
+    }
+    if(v.node != home && v.count >= homeMigrateThreshold)
+        return v.node;
+    return NoHomeNode;
+}
+
+void SMPCache::setHome(PAddr addr, int32_t node) {
+    dirMap[addr >> homeBlockShift] = node;
+    // The new home must be out-voted by twice the threshold to move again
+    HomeVote &v = homeVotes[addr >> homeBlockShift];
+    v.node  = node;
+    v.count = homeMigrateThreshold;
+}
+
+// The profile is a header (magic, homeBlockShift, number of records)
+// followed by one (block, node) record per block
+struct HomeProfileRecord {
+    uint32_t block;
+    int32_t  node;
+};
+
+void SMPCache::loadHomeProfile(const char *fname) {
+    // Every cache using the profile asks for it, but there is one home map
+    static bool loaded = false;
+    if(loaded)
+        return;
+    loaded = true;
+
+    FILE *fd = fopen(fname, "rb");
+    if(fd == 0)
+        fail("SMPCache: could not open home profile [%s]\n", fname);
+
+    char magic[sizeof(HomeProfileMagic)];
+    uint32_t hdr[2];
+    if(fread(magic, sizeof(magic), 1, fd) != 1
+            || memcmp(magic, HomeProfileMagic, sizeof(magic)) != 0
+            || fread(hdr, sizeof(hdr), 1, fd) != 1)
+        fail("SMPCache: [%s] is not a home profile\n", fname);
+    if((int32_t)hdr[0] != homeBlockShift)
+        fail("SMPCache: home profile [%s] has different home blocks\n", fname);
+
+    for(uint32_t i = 0; i < hdr[1]; i++) {
+        HomeProfileRecord r;
+        if(fread(&r, sizeof(r), 1, fd) != 1)
+            fail("SMPCache: home profile [%s] is truncated\n", fname);
+        dirMap[r.block] = r.node;
+    }
+    fclose(fd);
+}
+
+void SMPCache::writeHomeProfile() {
+    if(homeProfileOut == NULL)
+        return;
+
+    // Each block goes to its most frequent requester; blocks that were
+    // never requested below the L1s keep the home they had
+    std::vector<HomeProfileRecord> recs;
+    uint32_t nBlocks = dirMap.size() > homeVotes.size() ? dirMap.size() : homeVotes.size();
+    for(uint32_t b = 0; b < nBlocks; b++) {
+        HomeProfileRecord r;
+        r.block = b;
+        r.node  = homeVotes.get(b).node;
+        if(r.node == NoHomeNode)
+            r.node = dirMap.get(b);
+        if(r.node != NoHomeNode)
+            recs.push_back(r);
+    }
+
+    FILE *fd = fopen(homeProfileOut, "wb");
+    if(fd == 0) {
+        MSG("SMPCache: could not write home profile [%s]", homeProfileOut);
+        return;
+    }
+    uint32_t hdr[2] = { (uint32_t)homeBlockShift, (uint32_t)recs.size() };
+    fwrite(HomeProfileMagic, sizeof(HomeProfileMagic), 1, fd);
+    fwrite(hdr, sizeof(hdr), 1, fd);
+    if(!recs.empty())
+        fwrite(&recs[0], sizeof(HomeProfileRecord), recs.size(), fd);
+    fclose(fd);
 }
 
 #ifdef SESC_SMP_DEBUG
@@ -28,6 +28,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "SMPMemRequest.h"
 #include "SMPCacheState.h"
 #include "SMPSystemBus.h"
+#include "SMPPrefetcher.h"
 #include "MSHR.h"
 #include "Port.h"
 
@@ -49,6 +50,56 @@ enum HomeDirectoryType_e {
     HDT_N
 };
 
+enum { NoHomeNode = -1 };
+
+// Per-block state of the home placement policies, indexed by home block
+// (2^homeDirBlockSize lines). A dense array split into chunks that are
+// allocated the first time one of their blocks is looked up.
+template<class T>
+class HomeBlockTable {
+private:
+    enum { ChunkBits = 12, ChunkSize = 1 << ChunkBits };
+    std::vector<T *> chunks;
+    const T init;
+public:
+    HomeBlockTable(const T &init) : init(init) {
+    }
+    ~HomeBlockTable() {
+        for(size_t i = 0; i < chunks.size(); i++)
+            delete [] chunks[i];
+    }
+    T &operator[](uint32_t blockIndex) {
+        uint32_t c = blockIndex >> ChunkBits;
+        if(c >= chunks.size())
+            chunks.resize(c + 1, 0);
+        if(chunks[c] == 0) {
+            chunks[c] = new T[ChunkSize];
+            for(int32_t i = 0; i < ChunkSize; i++)
+                chunks[c][i] = init;
+        }
+        return chunks[c][blockIndex & (ChunkSize - 1)];
+    }
+    // Number of blocks covered by the allocated chunks
+    uint32_t size() const {
+        return chunks.size() << ChunkBits;
+    }
+    // Entry of a block, or init if its chunk was never allocated
+    const T &get(uint32_t blockIndex) const {
+        uint32_t c = blockIndex >> ChunkBits;
+        if(c >= chunks.size() || chunks[c] == 0)
+            return init;
+        return chunks[c][blockIndex & (ChunkSize - 1)];
+    }
+};
+typedef HomeBlockTable<int16_t> HomeNodeTable;
+
+// Running vote for the most frequent requester of a home block: the count
+// goes up on requests from node and down on requests from anyone else, and
+// node is replaced when the count reaches zero
+struct HomeVote {
+    int16_t  node;
+    uint16_t count;
+};
 
 class SMPCache : public MemObj {
 public:
@@ -73,7 +124,17 @@ protected:
     TimeDelta_t l1CacheHitDelay;
 
     MSHR<PAddr, SMPCache> *outsReq; // buffer for requests coming from upper levels
-    static std::map<PAddr, int> dirMap;
+    SMPPrefetcher *prefetcher;      // NULL if this cache does not prefetch
+    static HomeNodeTable dirMap;
+    // Home placement state shared by all caches. homeBlockShift is log2 of
+    // the bytes in a home block.
+    static int32_t homeBlockShift;
+    static int32_t homeStrideNodes; // Nodes interleaved over, 0 unless stride
+    static bool    homeDynamic;
+    static uint16_t homeMigrateThreshold;
+    static const char *homeProfileOut;
+    static HomeBlockTable<HomeVote> homeVotes;
+    static void loadHomeProfile(const char *fname);
     //static MSHR<PAddr, SMPCache> *mutExclBuffer;
 
 
@@ -159,6 +220,7 @@ protected:
     void concludeWriteBack(Time_t initialTime);
     void sendRead(MemRequest* mreq);
     void sendWrite(MemRequest* mreq);
+    void issuePrefetches(PAddr addr);
 
     typedef CallbackMember1<SMPCache, MemRequest *,
             &SMPCache::doRead> doReadCB;
@@ -188,6 +250,38 @@ public:
 
 	static void PrintStat();
 
+    // Home placement hooks for the directory slices. Requests are counted
+    // only when placement is dynamic or a profile is being written.
+    static bool isHomeVoting() {
+        return homeDynamic || homeProfileOut;
+    }
+    static bool isHomeDynamic() {
+        return homeDynamic;
+    }
+    static PAddr getHomeBlockAddr(PAddr addr) {
+        return (addr >> homeBlockShift) << homeBlockShift;
+    }
+    static size_t getHomeBlockSize() {
+        return static_cast<size_t>(1) << homeBlockShift;
+    }
+    static int32_t getCurrentHome(PAddr addr) {
+        return dirMap.get(addr >> homeBlockShift);
+    }
+    // Home of addr under any placement, or NoHomeNode if it is not placed yet
+    static int32_t findHome(PAddr addr) {
+        if(homeBlockShift < 0)
+            return NoHomeNode;
+        if(homeStrideNodes)
+            return (addr >> homeBlockShift) % homeStrideNodes;
+        return getCurrentHome(addr);
+    }
+    // Counts a request for addr from node, and returns the node the block
+    // should migrate to, or NoHomeNode
+    static int32_t voteHome(PAddr addr, int32_t node, int32_t home);
+    static void setHome(PAddr addr, int32_t node);
+    // Writes the home of every block touched in this run to homeProfileOut
+    static void writeHomeProfile();
+
 #if (defined SIGDEBUG)
     void pStat();
 
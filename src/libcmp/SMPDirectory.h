@@ -3,6 +3,8 @@
 
 #include <malloc.h>
 
+#include "SMPDstSet.h"
+
 enum DirStatus {
     EXCLUSIVE = 0,
     SHARED,
@@ -127,8 +129,8 @@ public:
         return (dinfo.find(obj)!=dinfo.end());
     }
 
-    bool fillDst(std::set<int32_t> &d, std::set<MemObj*> &l, MemObj *ob) {
-        IJ(d.size()==0);
+    bool fillDst(SMPNodeMask &d, SMPObjList &l, MemObj *ob) {
+        IJ(d.empty());
         IJ(l.size()==0);
         bool found = false;
         for(std::set<MemObj*>::iterator it = dinfo.begin(); it!=dinfo.end(); it++) {
@@ -221,6 +223,27 @@ public:
         }
         return (*it).second;
     }
+
+    // A block can change home while none of its lines is busy or owned:
+    // only then can no writeback or intervention still be on its way here
+    bool canMigrate(PAddr fullAddr, size_t len) const {
+        std::map<PAddr, DirectoryEntry*>::const_iterator it = dirMap.lower_bound(calcTag(fullAddr));
+        for(; it!=dirMap.end() && (*it).first<=calcTag(fullAddr+len-1); it++) {
+            if((*it).second->isBusy() || (*it).second->getStatus()==EXCLUSIVE)
+                return false;
+        }
+        return true;
+    }
+    // Moves the entries of the block to the directory of its new home
+    void migrate(PAddr fullAddr, size_t len, Directory *to) {
+        std::map<PAddr, DirectoryEntry*>::iterator begIt = dirMap.lower_bound(calcTag(fullAddr));
+        std::map<PAddr, DirectoryEntry*>::iterator endIt = dirMap.upper_bound(calcTag(fullAddr+len-1));
+        for(std::map<PAddr, DirectoryEntry*>::iterator it = begIt; it!=endIt; it++) {
+            IJ(to->dirMap.find((*it).first)==to->dirMap.end());
+            to->dirMap[(*it).first] = (*it).second;
+        }
+        dirMap.erase(begIt, endIt);
+    }
 protected:
 private:
 #if (defined DEBUG_LEAK)
@@ -0,0 +1,114 @@
+#ifndef SMPDSTSET_H
+#define SMPDSTSET_H
+
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+class MemObj;
+
+///
+// Destination node set of a SMPMemRequest, one bit per node. Requests are
+// recycled through a pool and most carry one or two destinations, so a fixed
+// bitmask replaces the std::set the messages used to carry: clearing and
+// copying never allocate, and nodes iterate in increasing order as before.
+class SMPNodeMask {
+public:
+    enum { MaxNodes = 256 };
+
+private:
+    enum { WordBits = 64, NWords = MaxNodes / WordBits };
+    uint64_t words[NWords];
+
+public:
+    SMPNodeMask() {
+        clear();
+    }
+
+    void clear() {
+        memset(words, 0, sizeof(words));
+    }
+    void insert(int32_t n) {
+        words[n / WordBits] |= (1ULL << (n % WordBits));
+    }
+    void erase(int32_t n) {
+        words[n / WordBits] &= ~(1ULL << (n % WordBits));
+    }
+    bool has(int32_t n) const {
+        return (words[n / WordBits] >> (n % WordBits)) & 1;
+    }
+    bool empty() const {
+        for(int32_t i = 0; i < NWords; i++) {
+            if(words[i])
+                return false;
+        }
+        return true;
+    }
+    int32_t size() const {
+        int32_t n = 0;
+        for(int32_t i = 0; i < NWords; i++)
+            n += __builtin_popcountll(words[i]);
+        return n;
+    }
+
+    // Lowest node in the set, or -1 if it is empty
+    int32_t first() const {
+        return next(-1);
+    }
+    // Lowest node above n, or -1 if there is none
+    int32_t next(int32_t n) const {
+        n++;
+        for(int32_t i = n / WordBits; i < NWords; i++) {
+            uint64_t w = words[i];
+            if(i == n / WordBits)
+                w &= ~0ULL << (n % WordBits);
+            if(w)
+                return i * WordBits + __builtin_ctzll(w);
+        }
+        return -1;
+    }
+};
+
+///
+// Destination caches of a SMPMemRequest. Several caches share a node (the
+// L1s and the slice of a tile), so these cannot fold into the node mask. The
+// list holds a handful of entries at most; a vector searched linearly keeps
+// its storage across pool reuse instead of allocating a tree node per insert.
+class SMPObjList {
+private:
+    std::vector<MemObj *> objs;
+
+public:
+    typedef std::vector<MemObj *>::const_iterator const_iterator;
+
+    void clear() {
+        objs.clear();
+    }
+    void insert(MemObj *obj) {
+        if(!has(obj))
+            objs.push_back(obj);
+    }
+    void erase(MemObj *obj) {
+        std::vector<MemObj *>::iterator it = std::find(objs.begin(), objs.end(), obj);
+        if(it != objs.end())
+            objs.erase(it);
+    }
+    bool has(MemObj *obj) const {
+        return std::find(objs.begin(), objs.end(), obj) != objs.end();
+    }
+    bool empty() const {
+        return objs.empty();
+    }
+    int32_t size() const {
+        return objs.size();
+    }
+    const_iterator begin() const {
+        return objs.begin();
+    }
+    const_iterator end() const {
+        return objs.end();
+    }
+};
+
+#endif // SMPDSTSET_H
@@ -70,15 +70,15 @@ SMPMemRequest *SMPMemRequest::duplicate() {
             r->msgOwner = msgOwner;
         }
 
-        getDstNodes(r->dst);
-        getDstObjs(r->dstObj);
+        r->dst    = dst;
+        r->dstObj = dstObj;
 
         nSMPMsg[meshOp]--;
         return r;
     } else {
         SMPMemRequest *r = SMPMemRequest::create(this, requestor, meshOp);
-        getDstNodes(r->dst);
-        getDstObjs(r->dstObj);
+        r->dst    = dst;
+        r->dstObj = dstObj;
 
         nSMPMsg[meshOp]--;
         return r;
@@ -121,7 +121,6 @@ SMPMemRequest *SMPMemRequest::create(MemRequest *mreq,
     I(sreq->memStack.empty());
 
     IJ(sreq->memStack.empty());
-    IJ(sreq->clockStack.empty());
 
     sreq->currentClockStamp = globalClock;
 
@@ -296,9 +295,7 @@ void SMPMemRequest::destroy()
 
         GLOG(SMPDBG_MSGS, "sreq %p real destroy", this);
         I(memStack.empty());
-        while(!memStack.empty()) {
-            memStack.pop();
-        }
+        memStack.clear();
         rPool.in(this);
         return;
     }
@@ -316,12 +313,7 @@ void SMPMemRequest::destroy()
 
     nUses = 0;
     GLOG(SMPDBG_MSGS, "sreq %p real destroy", this);
-    while(!memStack.empty()) {
-        memStack.pop();
-    }
-    while(!clockStack.empty()) {
-        clockStack.pop();
-    }
+    memStack.clear();
     dst.clear();
     dstObj.clear();
     dentry = NULL;
@@ -26,6 +26,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "libcore/MemRequest.h"
 #include "SMPDebug.h"
 #include "SMPDirectory.h"
+#include "SMPDstSet.h"
 
 enum MeshOperation {
     ReadRequest 		= 0x00010008,
@@ -57,6 +58,8 @@ enum MeshOperation {
 
     UpgradeRequest		= 0x00A00008,
     ExclusiveReplyInvND	= 0x00B00008,
+    // Directory update sent to the home by a NUCA copy that served a read
+    NucaDirUpdate		= 0x00C00008,
 
     //WriteBackRequest	= 0x01000008,
     WriteBackExAck		= 0x02000008,
@@ -110,8 +113,8 @@ public:
     }
 
     // JJO
-    std::set<int32_t> dst;
-    std::set<MemObj*> dstObj;
+    SMPNodeMask dst;
+    SMPObjList dstObj;
     int32_t src;
     MeshOperation meshOp;
     //MeshOperation saveMeshOp;
@@ -178,31 +181,13 @@ public:
         return dst.size();
     }
     bool isDstNode(int32_t d) {
-        return (dst.find(d)!=dst.end());
-    }
-    void getDstNodes(std::set<int32_t> &l) {
-        IJ(l.size()==0);
-        if(dst.empty()) {
-            l.clear();
-        } else {
-            l.insert(dst.begin(), dst.end());
-        }
-    }
-    void getDstObjs(std::set<MemObj *> &l) {
-        IJ(l.size()==0);
-        if(dstObj.empty()) {
-            l.clear();
-        } else {
-            l.insert(dstObj.begin(), dstObj.end());
-        }
+        return dst.has(d);
     }
 
     int32_t getFirstDstNode() {
-        if(dst.size()>0) {
-            return (*dst.begin());
-        }
-        IJ(0);
-        return -1;
+        int32_t d = dst.first();
+        IJ(d>=0);
+        return d;
     }
 
     void setDirInfo(DirectoryEntry *de);
@@ -211,8 +196,8 @@ public:
         if(dst.empty()) {
             printf("MEM ");
         } else {
-            for(std::set<int32_t>::iterator it = dst.begin(); it!=dst.end(); it++) {
-                printf("%d, ", (*it));
+            for(int32_t d = dst.first(); d>=0; d = dst.next(d)) {
+                printf("%d, ", d);
             }
         }
     }
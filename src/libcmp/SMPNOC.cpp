@@ -158,6 +158,8 @@ SMPNOC::SMPNOC(SMemorySystem *dms, const char *section, const char *name)
 	}   
 
 
+    prefetchClass = (bs_config.GetInt("classes") > 1) ? 1 : 0;
+
     subnets = bs_config.GetInt("subnets");
     /*To include a new network, must register the network here
      *add an else if statement with the name of the network
@@ -519,7 +521,8 @@ void SMPNOC::read(MemRequest *mreq)
 				, from, to, meshOp, msgSize, addr, globalClock, sreq);
 
 		SMPPacket *p = SMPPacket::Get(mreq, from, to, msgSize, meshOp, addr, globalClock);
-		trafficManager->BufferPacket(from, to, 0, msgSize, (void *)p);
+		int cl = sreq->isPrefetch() ? prefetchClass : 0;
+		trafficManager->BufferPacket(from, to, cl, msgSize, (void *)p);
 
 	//doInject(mreq);
 	}
@@ -530,13 +533,12 @@ void SMPNOC::read(MemRequest *mreq)
 #if 0
     if(nDst>0) {
         // distribute requests to other caches, wait for responses
-        std::set<int32_t> dstCopy;
-        sreq->getDstNodes(dstCopy);
+        SMPNodeMask dstCopy = sreq->dst;
         int32_t srcCopy = sreq->getSrcNode();
 
         for(uint32_t i = 0; i<upperLevel.size(); i++) {
             //if(sreq->isDstNode(upperLevel[i]->getNodeID())) {
-            if(dstCopy.find(upperLevel[i]->getNodeID())!=dstCopy.end()) {
+            if(dstCopy.has(upperLevel[i]->getNodeID())) {
                 if(upperLevel[i]->getNodeID() != srcCopy) {
                     upperLevel[i]->returnAccess(mreq);
                 }
@@ -608,13 +610,12 @@ void SMPNOC::doRead(MemRequest *mreq)
     int nDst = sreq->numDstNode();
     if(nDst>0) {
         // distribute requests to other caches, wait for responses
-        std::set<int32_t> dstCopy;
-        sreq->getDstNodes(dstCopy);
+        SMPNodeMask dstCopy = sreq->dst;
         int32_t srcCopy = sreq->getSrcNode();
 
         for(uint32_t i = 0; i<upperLevel.size(); i++) {
             //if(sreq->isDstNode(upperLevel[i]->getNodeID())) {
-            if(dstCopy.find(upperLevel[i]->getNodeID())!=dstCopy.end()) {
+            if(dstCopy.has(upperLevel[i]->getNodeID())) {
                 if(upperLevel[i]->getNodeID() != srcCopy) {
                     upperLevel[i]->returnAccess(mreq);
                 }
@@ -100,6 +100,9 @@ protected:
 	std::vector<Network *> net;
 	int subnets;
 	BookSimConfig bs_config;
+	// Traffic class of prefetch messages. With classes = 2 in the booksim
+	// configuration they use class 1, and class_priority decides who wins.
+	int prefetchClass;
 
     //typedef HASH_MAP<MemRequest *, int32_t, SMPMemReqHashFunc> PendReqsTable;
     //PendReqsTable pendReqsTable;
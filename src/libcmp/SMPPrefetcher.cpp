@@ -0,0 +1,118 @@
+#include <string.h>
+
+#include "SescConf.h"
+#include "libemul/EmulInit.h"
+#include "SMPPrefetcher.h"
+
+static const PAddr NoLine = (PAddr)-1;
+
+SMPPrefetcher *SMPPrefetcher::create(const char *section, const char *name, int32_t lineSize)
+{
+    if(!SescConf->checkCharPtr(section, "prefetcher"))
+        return NULL;
+
+    const char *pfSection = SescConf->getCharPtr(section, "prefetcher");
+    const char *type = SescConf->getCharPtr(pfSection, "type");
+    if(strcasecmp(type, "stride"))
+        fail("[%s] unknown prefetcher type [%s]\n", name, type);
+
+    return new SMPPrefetcher(pfSection, name, lineSize);
+}
+
+SMPPrefetcher::SMPPrefetcher(const char *section, const char *name, int32_t lineSize)
+    : tracked(TrackSize, NoLine)
+    , lineSize(lineSize)
+    , windowIssued(0)
+    , windowUseful(0)
+    , pfIssued("%s:pfIssued", name)
+    , pfUseful("%s:pfUseful", name)
+    , pfThrottled("%s:pfThrottled", name)
+    , pfDegreeDown("%s:pfDegreeDown", name)
+    , pfDegreeUp("%s:pfDegreeUp", name)
+{
+    SescConf->isGT(section, "depth", 0);
+    maxDegree = SescConf->getInt(section, "depth");
+    degree    = maxDegree;
+
+    SescConf->isGT(section, "missWindow", 0);
+    missWindow = SescConf->getInt(section, "missWindow");
+
+    SescConf->isGT(section, "maxStride", 0);
+    maxStride = SescConf->getInt(section, "maxStride");
+
+    SescConf->isInt(section, "mshrReserve");
+    mshrReserve = SescConf->getInt(section, "mshrReserve");
+
+    SescConf->isGT(section, "accuracyWindow", 0);
+    accuracyWindow = SescConf->getInt(section, "accuracyWindow");
+
+    SescConf->isBetween(section, "lowAccuracy", 0, 100);
+    lowAccuracy = SescConf->getInt(section, "lowAccuracy");
+    SescConf->isBetween(section, "highAccuracy", lowAccuracy, 100);
+    highAccuracy = SescConf->getInt(section, "highAccuracy");
+}
+
+int32_t SMPPrefetcher::learnMiss(PAddr addr)
+{
+    PAddr paddr = addr & ~(lineSize - 1);
+
+    // The stride is the unit stride if a neighbouring line missed recently,
+    // and the smallest distance to a recent miss otherwise
+    uint32_t minDelta = (uint32_t)-1;
+    bool goingUp = true;
+    for(std::deque<PAddr>::const_iterator it = lastMisses.begin(); it != lastMisses.end(); it++) {
+        uint32_t delta = (paddr < *it) ? (*it - paddr) : (paddr - *it);
+        if(delta == (uint32_t)lineSize) {
+            minDelta = delta;
+            goingUp  = (paddr > *it);
+            break;
+        }
+        if(delta < minDelta) {
+            minDelta = delta;
+            goingUp  = (paddr > *it);
+        }
+    }
+
+    lastMisses.push_back(paddr);
+    if(lastMisses.size() > missWindow)
+        lastMisses.pop_front();
+
+    if(minDelta == 0 || minDelta == (uint32_t)-1 || minDelta > maxStride)
+        return 0;
+
+    return goingUp ? (int32_t)minDelta : -(int32_t)minDelta;
+}
+
+void SMPPrefetcher::issued(PAddr addr)
+{
+    PAddr line = addr / lineSize;
+    tracked[line % TrackSize] = line;
+    pfIssued.inc();
+
+    windowIssued++;
+    if(windowIssued < accuracyWindow)
+        return;
+
+    int32_t accuracy = (100 * windowUseful) / windowIssued;
+    if(accuracy < lowAccuracy && degree > 1) {
+        degree--;
+        pfDegreeDown.inc();
+    } else if(accuracy > highAccuracy && degree < maxDegree) {
+        degree++;
+        pfDegreeUp.inc();
+    }
+    windowIssued = 0;
+    windowUseful = 0;
+}
+
+void SMPPrefetcher::demandHit(PAddr addr)
+{
+    PAddr line = addr / lineSize;
+    PAddr &t = tracked[line % TrackSize];
+    if(t != line)
+        return;
+
+    t = NoLine;
+    pfUseful.inc();
+    windowUseful++;
+}
@@ -0,0 +1,74 @@
+#ifndef SMPPREFETCHER_H
+#define SMPPREFETCHER_H
+
+#include <deque>
+#include <vector>
+
+#include "GStats.h"
+#include "libemul/Addressing.h"
+
+///
+// Stride prefetcher for the coherent CMP caches (SMPCache and
+// SMPSliceCache). It does not sit in the memory hierarchy like the libmem
+// prefetchers: the cache it belongs to trains it on demand misses and then
+// issues the predicted lines itself, as ordinary coherent reads marked as
+// prefetches, skipping lines that are present or already pending.
+//
+// Prefetching backs off on two signals. The cache stops issuing while fewer
+// than mshrReserve of its MSHR entries are free, so demand misses always
+// find room, and every accuracyWindow prefetches the degree drops by one if
+// fewer than lowAccuracy% of them were used by a demand access, or grows by
+// one (up to depth) if more than highAccuracy% were.
+class SMPPrefetcher {
+private:
+    // Lines issued and not yet used, direct mapped by line address
+    enum { TrackSize = 1024 };
+    std::vector<PAddr> tracked;
+
+    std::deque<PAddr> lastMisses;
+
+    const int32_t lineSize;
+    uint32_t missWindow;
+    uint32_t maxStride;
+    int32_t  maxDegree;
+    int32_t  degree;
+    int32_t  mshrReserve;
+    int32_t  accuracyWindow;
+    int32_t  lowAccuracy;
+    int32_t  highAccuracy;
+
+    int32_t  windowIssued;
+    int32_t  windowUseful;
+
+    GStatsCntr pfIssued;
+    GStatsCntr pfUseful;
+    GStatsCntr pfThrottled;
+    GStatsCntr pfDegreeDown;
+    GStatsCntr pfDegreeUp;
+
+    SMPPrefetcher(const char *section, const char *name, int32_t lineSize);
+
+public:
+    // Returns the prefetcher configured in section, or NULL when it has none
+    static SMPPrefetcher *create(const char *section, const char *name, int32_t lineSize);
+
+    // Records a demand miss and returns the stride, in bytes and signed, of
+    // the stream it continues, or 0 if it does not continue one
+    int32_t learnMiss(PAddr addr);
+
+    int32_t getDegree() const {
+        return degree;
+    }
+    int32_t getMSHRReserve() const {
+        return mshrReserve;
+    }
+
+    void issued(PAddr addr);
+    void throttled() {
+        pfThrottled.inc();
+    }
+    // A demand access hit addr
+    void demandHit(PAddr addr);
+};
+
+#endif // SMPPREFETCHER_H
@@ -193,9 +193,7 @@ void SMPRouter::doRead(MemRequest *mreq)
     newSreq->ttl = sreq->numDstNode();
     newSreq->src = sreq->src;
     newSreq->dst.clear();
-    for(std::set<int32_t>::iterator it = sreq->dst.begin(); it!=sreq->dst.end(); it++) {
-        newSreq->dst.insert((*it));
-    }
+    newSreq->dst = sreq->dst;
 #endif
 
 
@@ -226,7 +224,7 @@ void SMPRouter::doRead(MemRequest *mreq)
             DEBUGPRINT("       [%s] Converting Inv message to %d packets for %x at %lld\n",
                        getSymbolicName(), (int)sreq->dstObj.size(), addr, globalClock);
 
-            for(std::set<MemObj*>::iterator it = sreq->dstObj.begin(); it!=sreq->dstObj.end(); it++) {
+            for(SMPObjList::const_iterator it = sreq->dstObj.begin(); it!=sreq->dstObj.end(); it++) {
                 SMPMemRequest *nsreq = SMPMemRequest::create(sreq, Invalidation);
 	
                 nsreq->addDstNode((*it)->getNodeID());
@@ -377,8 +375,8 @@ void SMPRouter::returnAccess(MemRequest *mreq)
     // If broadcast, filter which is not mine
     SMPMemRequest *sreq = static_cast<SMPMemRequest *>(mreq);
 
-    std::set<MemObj*> dstObjCopy;
-    sreq->getDstObjs(dstObjCopy);
+    // Copied, as delivering the message to one cache may recycle it
+    SMPObjList dstObjCopy = sreq->dstObj;
 
     DEBUGPRINT("      [%s] Recieved at router %d (dst %d) from %d for %x at %lld  (%p)\n",
                getSymbolicName(), getNodeID(), (int)dstObjCopy.size(), sreq->getSrcNode(), sreq->getPAddr(), globalClock, mreq);
@@ -406,7 +404,7 @@ void SMPRouter::returnAccess(MemRequest *mreq)
     if(!dstObjCopy.empty()) {
         bool found = false;
         for(int i=(int)getUpperLevelSize()-1; i>=0; i--) {
-            if(dstObjCopy.find(upperLevel[i])!=dstObjCopy.end()) {
+            if(dstObjCopy.has(upperLevel[i])) {
                 upperLevel[i]->returnAccess(mreq);
                 found = true;
             }
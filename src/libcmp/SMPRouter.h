@@ -48,7 +48,6 @@ private:
 
 	int dimX;
 	int dimY;
-	int calcDist(int s, int d);
 
 protected:
     PortGeneric *busPort;
@@ -108,6 +107,8 @@ public:
     int32_t getNodeID() {
         return nodeID;
     }
+    // Hops between two nodes of the mesh, as counted in the message stats
+    int calcDist(int s, int d);
 
     static uint64_t mdestStat;
     static uint64_t mtotDestStat;
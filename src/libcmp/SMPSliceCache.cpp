@@ -37,6 +37,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "libcore/GProcessor.h"
 
 #include "SMPCache.h"
+#include "SMPRouter.h"
 
 #include "SMPMemRequest.h"
 #include "SMemorySystem.h"
@@ -50,6 +51,7 @@ extern char* MemOperationStr[];
 extern char* DirStatusStr[];
 
 Directory **SMPSliceCache::globalDirMap;
+SMPSliceCache **SMPSliceCache::globalSliceMap;
 
 //#define DEBUGPRINT printf
 GStatsCntr SMPSliceCache::Read_U("Read_U");
@@ -93,6 +95,13 @@ SMPSliceCache::SMPSliceCache(SMemorySystem *gms, const char *section, const char
     ,avgMissLat("%s_avgMissLat", name)
     ,rejected("%s:rejected", name)
     ,rejectedHits("%s:rejectedHits", name)
+    ,homeMigrations("%s:homeMigrations", name)
+    ,nucaLocalHits("%s:nucaLocalHits", name)
+    ,nucaReplicas("%s:nucaReplicas", name)
+    ,nucaMigrations("%s:nucaMigrations", name)
+    ,nucaVictims("%s:nucaVictims", name)
+    ,nucaCopyInvs("%s:nucaCopyInvs", name)
+    ,nucaHopsSaved("%s_nucaHopsSaved", name)
 #ifdef MSHR_BWSTATS
     ,secondaryMissHist("%s:secondaryMissHist", name)
     ,accessesHist("%s:accessHistBySecondaryMiss", name)
@@ -109,6 +118,12 @@ SMPSliceCache::SMPSliceCache(SMemorySystem *gms, const char *section, const char
         globalDirMap = new Directory *[gms->getPPN()];
     }
     globalDirMap[gms->getPID()] = dir;
+    if(!globalSliceMap) {
+        globalSliceMap = new SMPSliceCache *[gms->getPPN()];
+        for(uint32_t i = 0; i < gms->getPPN(); i++)
+            globalSliceMap[i] = 0;
+    }
+    globalSliceMap[gms->getPID()] = this;
 
     SescConf->isInt(section, "numPortsDir");
     SescConf->isInt(section, "portOccpDir");
@@ -145,6 +160,8 @@ SMPSliceCache::SMPSliceCache(SMemorySystem *gms, const char *section, const char
     bankMSHRs[0] = MSHR<PAddr,SMPSliceCache>::create(tmpName, mshrSection);
     nAccesses[0] = new GStatsCntr("%s_B%d:nAccesses", name, 0);
 
+    prefetcher = SMPPrefetcher::create(section, name, cacheBanks[0]->getLineSize());
+
     for(int32_t b = 1; b < nBanks; b++) {
         sprintf(tmpName, "%s_B%d", name, b);
         cacheBanks[b] = CacheType::create(section, "", tmpName);
@@ -234,6 +251,25 @@ SMPSliceCache::SMPSliceCache(SMemorySystem *gms, const char *section, const char
     	inv_opt = SescConf->getBool(section, "invOpt");
     }
 
+    nucaPolicy = NUCA_STATIC;
+    migrateThreshold = 0;
+    if(SescConf->checkCharPtr(section, "nucaPolicy")) {
+        const char *policy = SescConf->getCharPtr(section, "nucaPolicy");
+        if(strcasecmp(policy, "static") == 0) {
+            nucaPolicy = NUCA_STATIC;
+        } else if(strcasecmp(policy, "replicate") == 0) {
+            nucaPolicy = NUCA_REPLICATE;
+        } else if(strcasecmp(policy, "migrate") == 0) {
+            nucaPolicy = NUCA_MIGRATE;
+            SescConf->isGT(section, "migrateThreshold", 0);
+            migrateThreshold = SescConf->getInt(section, "migrateThreshold");
+        } else if(strcasecmp(policy, "victim") == 0) {
+            nucaPolicy = NUCA_VICTIM;
+        } else {
+            fail("[SMPSliceCache::%s] unknown nucaPolicy [%s]\n", name, policy);
+        }
+    }
+
 
 
 #ifdef MSHR_BWSTATS
@@ -257,6 +293,7 @@ SMPSliceCache::~SMPSliceCache()
     delete [] bankMSHRs;
     delete [] bankPorts;
     delete [] mshrPorts;
+    delete prefetcher;
 }
 
 void SMPSliceCache::access(MemRequest *mreq)
@@ -323,10 +360,17 @@ void SMPSliceCache::L2writeBackReturn(MemRequest *mreq, TimeDelta_t d) {
 void SMPSliceCache::L2requestReturn(MemRequest *mreq, TimeDelta_t d) {
     SMPMemRequest *sreq = static_cast<SMPMemRequest *>(mreq);
     if(sreq->getMeshOperation()==MeshMemAccessReply) {
-        IJ(sreq->saveReq);
+        if(sreq->saveReq == NULL) {
+            // Prefetched by this slice, nobody is waiting for the line
+            IJ(sreq->isPrefetch());
+            sreq->destroy();
+            return;
+        }
+        nucaReply(sreq->saveReq);
         sreq->saveReq->goDown(d, lowerLevel[0]);
         sreq->destroy();
     } else {
+        nucaReply(sreq);
         sreq->goDown(d, lowerLevel[0]);
     }
 #if 0
@@ -361,6 +405,8 @@ void SMPSliceCache::doRead(MemRequest *mreq)
 
     readHit.inc();
     l->incReadAccesses();
+    if(prefetcher)
+        prefetcher->demandHit(mreq->getPAddr());
 
     //mreq->goUp(hitDelay);
     L2requestReturn(mreq, hitDelay);
@@ -407,10 +453,51 @@ void SMPSliceCache::readMissHandler(MemRequest *mreq)
     }
 #endif
 
+    if(prefetcher)
+        issuePrefetches(addr);
+
+    sendMiss(mreq);
+}
 
+// The slice only prefetches lines it is the home of, straight from memory
+// into its data banks, so the directory is not involved: no L1 holds the
+// line and the next request for it finds the data here. Prefetches share
+// the bank MSHRs with demand misses and are dropped when a bank runs low.
+void SMPSliceCache::issuePrefetches(PAddr addr)
+{
+    int32_t stride = prefetcher->learnMiss(addr);
+    if(stride == 0)
+        return;
 
+    PAddr pfAddr = addr & defaultMask;
+    for(int32_t i = 0; i < prefetcher->getDegree(); i++) {
+        PAddr next = pfAddr + stride;
+        if((stride > 0) != (next > pfAddr))
+            break; // wrapped around the address space
+        pfAddr = next;
+
+        if(SMPCache::findHome(pfAddr) != getNodeID())
+            continue;
+        if(getCacheBank(pfAddr)->findLineNoEffect(pfAddr) || isInWBuff(pfAddr)
+                || getBankMSHR(pfAddr)->hasEntry(pfAddr))
+            continue;
+        if(getBankMSHR(pfAddr)->getnFreeEntries() <= prefetcher->getMSHRReserve()) {
+            prefetcher->throttled();
+            continue;
+        }
+        if(!getBankMSHR(pfAddr)->issue(pfAddr, MemRead))
+            continue;
 
-    sendMiss(mreq);
+        SMPMemRequest *preq = SMPMemRequest::create(this, pfAddr, MemRead, false, 0, MeshMemAccess);
+        preq->markPrefetch();
+        preq->msgOwner = this;
+        prefetcher->issued(pfAddr);
+
+        DEBUGPRINT("   [%s] L2 prefetch (go to Mem) for %x at %lld  (%p)\n",
+                   getSymbolicName(), pfAddr, globalClock, preq);
+
+        preq->goDown(missDelay + (nextMSHRSlot(pfAddr)-globalClock), lowerLevel[0]);
+    }
 }
 
 void SMPSliceCache::doReadQueued(MemRequest *mreq)
@@ -581,6 +668,259 @@ void SMPSliceCache::specialOp(MemRequest *mreq)
     mreq->goUp(1);
 }
 
+// Counts requests toward home placement and, with dynamic placement, moves
+// the home of a block to the node that requests it most. A request that
+// arrives at a slice that is no longer the home of its block is NAK'd, so
+// the requester retries at the new home. Lines left in this slice's data
+// banks are not moved and age out as usual.
+bool SMPSliceCache::checkHome(SMPMemRequest *sreq)
+{
+    if(sreq->meshOp != ReadRequest && sreq->meshOp != WriteRequest
+            && sreq->meshOp != UpgradeRequest)
+        return true;
+
+    PAddr addr = sreq->getPAddr();
+    if(SMPCache::isHomeDynamic() && SMPCache::getCurrentHome(addr) != getNodeID()) {
+        // Sent before the block migrated away
+    } else {
+        int32_t dst = SMPCache::voteHome(addr, sreq->msgOwner->getNodeID(), getNodeID());
+        if(!SMPCache::isHomeDynamic() || dst == NoHomeNode)
+            return true;
+        PAddr  base = SMPCache::getHomeBlockAddr(addr);
+        size_t len  = SMPCache::getHomeBlockSize();
+        if(!dir->canMigrate(base, len))
+            return true;
+
+        DEBUGPRINT("   [%s] Home of %x moves to %d at %lld\n",
+                   getSymbolicName(), addr, dst, globalClock);
+        dir->migrate(base, len, globalDirMap[dst]);
+        SMPCache::setHome(addr, dst);
+        homeMigrations.inc();
+        // The new home does not know about copies registered here
+        dropCopies(base, len);
+    }
+
+    SMPMemRequest *nsreq = SMPMemRequest::create(sreq, this, NAK);
+    nsreq->addDst(sreq->msgOwner);
+    sreq->destroy();
+    nsreq->goDown(hitDelayDir, lowerLevel[0]);
+    return false;
+}
+
+// An L1 read miss first tries the slice of its own node, which may hold a
+// copy of the line under the replicate, migrate and victim policies. A copy
+// is only used while it is registered at the home, which drops its copies
+// before any write can reach the line, and only when the home would answer
+// from its data banks: the directory entry is not busy and the line is
+// unowned or shared. The entry is then updated here as the home would have,
+// and the request never crosses the network. The home still learns of the
+// new sharer through a one-way NucaDirUpdate message that occupies its
+// directory port off the critical path, so nucaHopsSaved counts the hops
+// of the avoided round trip net of that message.
+bool SMPSliceCache::nucaLocalRead(SMPMemRequest *sreq)
+{
+    if(!globalSliceMap)
+        return false;
+    SMPSliceCache *slice = globalSliceMap[sreq->msgOwner->getNodeID()];
+    if(!slice || slice->nucaPolicy == NUCA_STATIC)
+        return false;
+    return slice->localRead(sreq);
+}
+
+bool SMPSliceCache::localRead(SMPMemRequest *sreq)
+{
+    PAddr addr = sreq->getPAddr() & defaultMask;
+    int32_t home = sreq->getFirstDstNode();
+    if(home == getNodeID())
+        return false;
+
+    // Directory::find allocates an entry, so only look at the home
+    // directory once the line is known to have a copy here
+    NucaCopies &copies = globalSliceMap[home]->nucaCopies;
+    NucaCopies::iterator it = copies.find(addr);
+
+    if(it == copies.end() || !it->second.has(getNodeID())
+            || getCacheBank(addr)->findLineNoEffect(addr) == 0) {
+        nucaHopsSaved.sample(0);
+        return false;
+    }
+
+    DirectoryEntry *de = globalDirMap[home]->find(addr);
+    if(de->isBusy()
+            || (de->getStatus() != UNOWNED && de->getStatus() != SHARED)) {
+        nucaHopsSaved.sample(0);
+        return false;
+    }
+
+    MeshOperation reply;
+    if(de->getStatus() == UNOWNED) {
+        if(de->getNum() == 0)
+            de->addOwner(sreq->msgOwner);
+        de->setStatus(EXCLUSIVE);
+        reply = ExclusiveReply;
+    } else {
+        de->addSharer(sreq->msgOwner);
+        reply = SharedReply;
+    }
+
+    nucaLocalHits.inc();
+    nucaHopsSaved.sample(static_cast<SMPRouter *>(lowerLevel[0])->calcDist(getNodeID(), home));
+
+    DEBUGPRINT("   [%s] Local copy of %x (home %d) serves %s at %lld\n",
+               getSymbolicName(), addr, home, sreq->msgOwner->getSymbolicName(), globalClock);
+
+    SMPMemRequest *usreq = SMPMemRequest::create(this, addr, MemPush, false, 0, NucaDirUpdate);
+    usreq->msgOwner = sreq->msgOwner;
+    usreq->addDst(globalSliceMap[home]);
+    usreq->goDown(hitDelayDir, lowerLevel[0]);
+
+    SMPMemRequest *nsreq = SMPMemRequest::create(sreq, this, reply);
+    nsreq->addDst(sreq->msgOwner);
+    // The read request was never sent
+    SMPMemRequest::nSMPMsg[ReadRequest]--;
+    sreq->destroy();
+
+    read(nsreq);
+    return true;
+}
+
+// Called at the home for every reply leaving its data banks. Shared replies
+// to other nodes leave a replica in the reader's slice; a line granted
+// exclusively to the same remote node migrateThreshold times in a row moves
+// to that node's slice.
+void SMPSliceCache::nucaReply(SMPMemRequest *sreq)
+{
+    if(nucaPolicy != NUCA_REPLICATE && nucaPolicy != NUCA_MIGRATE)
+        return;
+    if(sreq->meshOp != SharedReply && sreq->meshOp != ExclusiveReply)
+        return;
+
+    PAddr addr = sreq->getPAddr() & defaultMask;
+    int32_t node = sreq->msgDst->getNodeID();
+    if(node == getNodeID() || SMPCache::findHome(addr) != getNodeID())
+        return;
+
+    if(nucaPolicy == NUCA_REPLICATE) {
+        if(sreq->meshOp == SharedReply && globalSliceMap[node]
+                && globalSliceMap[node]->installCopy(addr, true)) {
+            nucaCopies[addr].insert(node);
+            nucaReplicas.inc();
+        }
+        return;
+    }
+
+    if(sreq->meshOp != ExclusiveReply)
+        return;
+
+    MigrateVote &vote = migrateVotes[addr];
+    if(vote.node != node) {
+        vote.node  = node;
+        vote.count = 0;
+    }
+    if(vote.count < migrateThreshold)
+        vote.count++;
+    if(vote.count < migrateThreshold)
+        return;
+
+    Line *l = getCacheBank(addr)->findLineNoEffect(addr);
+    if(l == 0 || getBankMSHR(addr)->hasEntry(addr))
+        return;
+    if(!globalSliceMap[node] || !globalSliceMap[node]->installCopy(addr, true))
+        return;
+
+    // Copies are always clean, so they can be dropped without a writeback
+    if(l->isDirty()) {
+        doWriteBack(addr);
+        l->makeClean();
+    }
+    l->invalidate();
+    migrateVotes.erase(addr);
+    nucaCopies[addr].insert(node);
+    nucaMigrations.inc();
+}
+
+// Puts a clean copy of addr in this slice. Copies never displace dirty or
+// pending lines, and victim copies only displace other copies.
+bool SMPSliceCache::installCopy(PAddr addr, bool displaceHome)
+{
+    CacheType *bank = getCacheBank(addr);
+    Line *l = bank->findLineNoEffect(addr);
+    if(l)
+        return !l->isDirty();
+
+    if(isInWBuff(addr) || getBankMSHR(addr)->hasEntry(addr))
+        return false;
+
+    l = bank->findLine2Replace(addr);
+    if(l == 0)
+        return false;
+    if(l->isValid()) {
+        PAddr rpl_addr = bank->calcAddr4Tag(l->getTag());
+        if(l->isDirty() || l->isLocked() || getBankMSHR(rpl_addr)->hasEntry(rpl_addr))
+            return false;
+        if(!displaceHome && SMPCache::findHome(rpl_addr) == getNodeID())
+            return false;
+    }
+
+    nextBankSlot(addr);
+    l->setTag(bank->calcTag(addr));
+    l->validate();
+    return true;
+}
+
+void SMPSliceCache::dropCopy(PAddr addr)
+{
+    Line *l = getCacheBank(addr)->findLineNoEffect(addr);
+    if(l == 0)
+        return;
+    I(!l->isDirty());
+    l->invalidate();
+}
+
+void SMPSliceCache::dropCopies(PAddr addr)
+{
+    NucaCopies::iterator it = nucaCopies.find(addr & defaultMask);
+    if(it == nucaCopies.end())
+        return;
+
+    const SMPNodeMask &nodes = it->second;
+    for(int32_t n = nodes.first(); n >= 0; n = nodes.next(n)) {
+        globalSliceMap[n]->dropCopy(it->first);
+        nucaCopyInvs.inc();
+    }
+    nucaCopies.erase(it);
+}
+
+void SMPSliceCache::dropCopies(PAddr base, size_t len)
+{
+    std::vector<PAddr> lines;
+    for(NucaCopies::iterator it = nucaCopies.begin(); it != nucaCopies.end(); it++) {
+        if(it->first >= base && it->first - base < len)
+            lines.push_back(it->first);
+    }
+    for(size_t i = 0; i < lines.size(); i++)
+        dropCopies(lines[i]);
+}
+
+void SMPSliceCache::nucaVictim(int32_t node, PAddr addr)
+{
+    if(!globalSliceMap)
+        return;
+    SMPSliceCache *slice = globalSliceMap[node];
+    if(!slice || slice->nucaPolicy != NUCA_VICTIM)
+        return;
+
+    addr &= slice->defaultMask;
+    int32_t home = SMPCache::findHome(addr);
+    if(home == NoHomeNode || home == node)
+        return;
+    if(!slice->installCopy(addr, false))
+        return;
+
+    globalSliceMap[home]->nucaCopies[addr].insert(node);
+    slice->nucaVictims.inc();
+}
+
 void SMPSliceCache::doAccessDir(MemRequest *mreq)
 {
     SMPMemRequest *sreq = static_cast<SMPMemRequest *>(mreq);
@@ -589,6 +929,27 @@ void SMPSliceCache::doAccessDir(MemRequest *mreq)
 
     bool dataSent = false;
 
+    if(SMPCache::isHomeVoting() && !checkHome(sreq))
+        return;
+
+    // Copies in other slices must not outlive the data they were taken from
+    if(!nucaCopies.empty()) {
+        switch(sreq->meshOp) {
+        case WriteRequest:
+        case UpgradeRequest:
+        case SharingWriteBack:
+        case DirtyTransfer:
+            dropCopies(addr);
+            break;
+        case WriteBackRequest:
+            if(sreq->writeBack)
+                dropCopies(addr);
+            break;
+        default:
+            break;
+        }
+    }
+
     switch(sreq->meshOp) {
         //case ForwardRequestNAK:
     case ReadRequest:
@@ -916,13 +1277,13 @@ void SMPSliceCache::doAccessDir(MemRequest *mreq)
 							nsreq->goDown(hitDelayDir, lowerLevel[0]);
 							//nsreq->goDown(0, lowerLevel[0]);
 						} else {
-							std::set<int32_t> dst;
-    						std::set<MemObj*> dstObj;
+							SMPNodeMask dst;
+							SMPObjList dstObj;
 							de->fillDst(dst, dstObj, sreq->msgOwner);
 							nSharer = dstObj.size();
 							IJ(nSharer>0);
 
-							for(std::set<MemObj*>::iterator it = dstObj.begin(); it!=dstObj.end(); it++) {
+							for(SMPObjList::const_iterator it = dstObj.begin(); it!=dstObj.end(); it++) {
 
 								SMPMemRequest *nsreq = SMPMemRequest::create(sreq, this, Invalidation);
 								nsreq->clearDstNodes();
@@ -1408,6 +1769,14 @@ void SMPSliceCache::returnAccess(MemRequest *mreq)
                    getSymbolicName(), mreq->getPAddr(), sreq->getRequestor()->getSymbolicName(), globalClock);
         doAccessDirCB::scheduleAbs(nextDirSlot(), this, mreq);
         break;
+
+    case NucaDirUpdate:
+        DEBUGPRINT("   [%s] NucaDirUpdate received for %x from %s at %lld\n",
+                   getSymbolicName(), mreq->getPAddr(), sreq->getRequestor()->getSymbolicName(), globalClock);
+        // The entry was already updated by the copy, only the port is taken
+        nextDirSlot();
+        sreq->destroy();
+        break;
 #if 0
     case MeshMemWriteBack:
         DEBUGPRINT("   [%s] L2cache write bcak recieved on %x from %d at %lld\n",
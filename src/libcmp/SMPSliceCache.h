@@ -40,6 +40,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "libll/ThreadContext.h"
 
 #include "SMPMemRequest.h"
+#include "SMPPrefetcher.h"
 #include "SMemorySystem.h"
 
 #ifdef TASKSCALAR
@@ -47,6 +48,14 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "VMemReq.h"
 #endif
 
+// Where lines homed at one slice may also live (see SMPSliceCache::localRead)
+enum NucaPolicy {
+    NUCA_STATIC,    // only in the home slice
+    NUCA_REPLICATE, // read-shared lines are replicated in the reader's slice
+    NUCA_MIGRATE,   // private lines move to their user's slice
+    NUCA_VICTIM     // clean L1 victims are kept in the local slice
+};
+
 class SMPSliceCache: public MemObj
 {
 protected:
@@ -85,6 +94,7 @@ protected:
 
     CacheType **cacheBanks;
     MSHR<PAddr,SMPSliceCache> **bankMSHRs;
+    SMPPrefetcher *prefetcher;
 
     typedef HASH_MAP<PAddr, int> WBuff;
 
@@ -133,9 +143,35 @@ protected:
     GStatsAvg  avgMissLat;
     GStatsCntr rejected;
     GStatsCntr rejectedHits;
+    GStatsCntr homeMigrations;
+    GStatsCntr nucaLocalHits;
+    GStatsCntr nucaReplicas;
+    GStatsCntr nucaMigrations;
+    GStatsCntr nucaVictims;
+    GStatsCntr nucaCopyInvs;
+    GStatsAvg  nucaHopsSaved;
     GStatsCntr **nAccesses;
     // END Statistics
 
+    NucaPolicy nucaPolicy;
+    int32_t migrateThreshold;
+
+    // Lines homed here that have copies in other slices, and their nodes
+    typedef HASH_MAP<PAddr, SMPNodeMask> NucaCopies;
+    NucaCopies nucaCopies;
+
+    // Consecutive exclusive replies of a line to the same remote node
+    class MigrateVote {
+    public:
+        int32_t node;
+        int32_t count;
+        MigrateVote() {
+            node  = -1;
+            count = 0;
+        }
+    };
+    HASH_MAP<PAddr, MigrateVote> migrateVotes;
+
 #ifdef MSHR_BWSTATS
     GStatsHist secondaryMissHist;
     GStatsHist accessesHist;
@@ -189,6 +225,7 @@ protected:
     void activateOverflow(MemRequest *mreq);
 
     void readMissHandler(MemRequest *mreq);
+    void issuePrefetches(PAddr addr);
     void writeMissHandler(MemRequest *mreq);
 
     void wbuffAdd(PAddr addr);
@@ -241,7 +278,15 @@ protected:
     // JJO
     void processWriteBack(MemRequest *mreq);
     void doAccessDir(MemRequest *mreq);
+    bool checkHome(SMPMemRequest *sreq);
     void L2requestReturn(MemRequest *mreq, TimeDelta_t d);
+
+    bool localRead(SMPMemRequest *sreq);
+    void nucaReply(SMPMemRequest *sreq);
+    bool installCopy(PAddr addr, bool displaceHome);
+    void dropCopy(PAddr addr);
+    void dropCopies(PAddr addr);
+    void dropCopies(PAddr base, size_t len);
     //void L2writeBackReturn(MemRequest *mreq, TimeDelta_t d);
 
     typedef CallbackMember1<SMPSliceCache, MemRequest *,
@@ -263,6 +308,13 @@ public:
     }
 
     static Directory **globalDirMap;
+    static SMPSliceCache **globalSliceMap;
+
+    // Serves an L1 read miss from a copy in the slice of its node, if there
+    // is one, and returns whether it did
+    static bool nucaLocalRead(SMPMemRequest *sreq);
+    // Offers a clean line evicted from an L1 to the slice of its node
+    static void nucaVictim(int32_t node, PAddr addr);
 
     void access(MemRequest *mreq);
     virtual void read(MemRequest *mreq);
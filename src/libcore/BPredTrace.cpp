@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanassert.h"
+#include "BPredTrace.h"
+
+static const char BPredTraceMagic[8] = {'S','E','S','C','B','P','T','2'};
+
+void BPredTrace::toInstruction(const Record &r, Instruction &inst)
+{
+    memset(&inst, 0, sizeof(Instruction));
+
+    inst.opcode     = iBJ;
+    inst.subCode    = static_cast<InstSubType>(r.subCode);
+    inst.src1       = NoDependence;
+    inst.src2       = NoDependence;
+    inst.dest       = InvalidOutput;
+    inst.uEvent     = NoEvent;
+    inst.skipDelay  = r.skipDelay;
+    inst.guessTaken = (r.flags & GuessTaken) != 0;
+    inst.condLikely = (r.flags & CondLikely) != 0;
+    inst.jumpLabel  = (r.flags & JumpLabel) != 0;
+    inst.addr       = r.pc;
+}
+
+BPredTraceWriter::BPredTraceWriter(const char *fname)
+    : out(fname)
+    , nInsts(0)
+{
+    out.write(BPredTraceMagic, sizeof(BPredTraceMagic));
+}
+
+BPredTraceWriter::~BPredTraceWriter()
+{
+    // Instructions after the last branch still count towards MPKI
+    BPredTrace::Record r;
+    memset(&r, 0, sizeof(r));
+    r.nInsts    = nInsts;
+    r.subCode   = BPredTrace::EndMark;
+    out.write(&r, sizeof(r));
+
+    out.close();
+}
+
+void BPredTraceWriter::record(const Instruction *inst, InstID oracleID)
+{
+    I(inst->isBranch());
+
+    BPredTrace::Record r;
+    r.pc        = inst->currentID();
+    r.oracleID  = oracleID;
+    r.nInsts    = nInsts;
+    r.subCode   = static_cast<uint8_t>(inst->getSubCode());
+    r.flags     = (inst->guessAsTaken() ? BPredTrace::GuessTaken : 0)
+                  | (inst->isBJLikely() ? BPredTrace::CondLikely : 0)
+                  | (inst->doesJump2Label() ? BPredTrace::JumpLabel : 0);
+    r.skipDelay = static_cast<int8_t>(inst->calcNextInstID() - inst->currentID());
+    r.pad       = 0;
+    out.write(&r, sizeof(r));
+
+    nInsts = 0;
+}
+
+BPredTraceReader::BPredTraceReader(const char *fname)
+{
+    fd = fopen(fname, "rb");
+    if(fd == 0) {
+        fprintf(stderr, "BPredTraceReader: could not open file [%s]\n", fname);
+        exit(-3);
+    }
+
+    char magic[sizeof(BPredTraceMagic)];
+    if(fread(magic, sizeof(magic), 1, fd) != 1
+            || memcmp(magic, BPredTraceMagic, sizeof(magic)) != 0) {
+        fprintf(stderr, "BPredTraceReader: [%s] is not a branch trace\n", fname);
+        exit(-3);
+    }
+}
+
+BPredTraceReader::~BPredTraceReader()
+{
+    fclose(fd);
+}
+
+bool BPredTraceReader::next(BPredTrace::Record &r)
+{
+    return fread(&r, sizeof(r), 1, fd) == 1;
+}
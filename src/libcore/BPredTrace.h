@@ -0,0 +1,63 @@
+#ifndef BPREDTRACE_H
+#define BPREDTRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "AsyncFileWriter.h"
+#include "libll/Instruction.h"
+
+///
+// Branch outcome stream for offline predictor studies. FetchEngine records
+// every correct-path branch it predicts, and bpredreplay feeds the stream to
+// any number of BPredictor configurations without re-running the simulation.
+class BPredTrace {
+public:
+    struct Record {
+        uint32_t pc;
+        uint32_t oracleID;  // InstID that really followed the branch
+        uint32_t nInsts;    // Instructions fetched since the previous record
+        uint8_t  subCode;   // InstSubType of the branch, or EndMark
+        uint8_t  flags;
+        int8_t   skipDelay; // Bytes from pc to the fall-through (0, 4 or 8)
+        uint8_t  pad;
+    };
+    enum {
+        // Record that only carries the instruction count at the end
+        EndMark         = 0xFF,
+        GuessTaken      = 2,
+        CondLikely      = 4,
+        JumpLabel       = 8
+    };
+
+    // Rebuild a branch Instruction with the fields the predictors use
+    static void toInstruction(const Record &r, Instruction &inst);
+};
+
+class BPredTraceWriter {
+private:
+    AsyncFileWriter out;
+    uint32_t        nInsts;
+
+public:
+    BPredTraceWriter(const char *fname);
+    ~BPredTraceWriter();
+
+    void addInsts(long long n) {
+        nInsts += n;
+    }
+    void record(const Instruction *inst, InstID oracleID);
+};
+
+class BPredTraceReader {
+private:
+    FILE *fd;
+
+public:
+    BPredTraceReader(const char *fname);
+    ~BPredTraceReader();
+
+    bool next(BPredTrace::Record &r);
+};
+
+#endif // BPREDTRACE_H
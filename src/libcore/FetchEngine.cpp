@@ -87,6 +87,15 @@ FetchEngine::FetchEngine(int32_t cId
     SescConf->isBetween(bpredSection, "BTACDelay", 0, 1024);
     BTACDelay = SescConf->getInt(bpredSection, "BTACDelay");
 
+    bpredTrace = 0;
+    if (SescConf->checkCharPtr("cpucore", "bpredTrace", cId)) {
+        const char *traceName = SescConf->getCharPtr("cpucore", "bpredTrace", cId);
+        char *fname = (char *)malloc(strlen(traceName) + 16);
+        sprintf(fname, "%s.%d", traceName, i);
+        bpredTrace = new BPredTraceWriter(fname);
+        free(fname);
+    }
+
     missInstID = 0;
     missFetchTime = 0;
 #ifdef SESC_MISPATH
@@ -129,6 +138,7 @@ FetchEngine::~FetchEngine()
     I(nWPathInsts == 0);
 
     delete bpred;
+    delete bpredTrace;
 }
 
 bool FetchEngine::processBranch(DInst *dinst, ushort n2Fetched)
@@ -142,6 +152,8 @@ bool FetchEngine::processBranch(DInst *dinst, ushort n2Fetched)
 #else
     PredType prediction     = bpred->predict(inst, oracleID, !dinst->isFake());
 #endif
+    if (bpredTrace && !dinst->isFake())
+        bpredTrace->record(inst, oracleID);
 
     if( oracleID != inst->calcNextInstID() ) {
         fbSizeBB--;
@@ -244,6 +256,8 @@ void FetchEngine::realFetch(IBucket *bucket, int32_t fetchMax)
     ushort tmp = FetchWidth - n2Fetched;
 
     totalnInst+=tmp;
+    if (bpredTrace)
+        bpredTrace->addInsts(tmp);
     // JJ
     if(ThreadContext::simDone) {
 		if(ThreadContext::finalSkip==0) {
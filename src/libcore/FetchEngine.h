@@ -29,6 +29,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "libll/ExecutionFlow.h"
 #include "BPred.h"
+#include "BPredTrace.h"
 #include "GStats.h"
 
 
@@ -51,6 +52,8 @@ private:
     Pid_t pid;
 
     BPredictor *bpred;
+    // Records the branch outcomes for bpredreplay, if enabled
+    BPredTraceWriter *bpredTrace;
 
     ExecutionFlow flow;
 
@@ -164,6 +167,23 @@ public:
         return pid >= 0;
     }
 
+    // True if fetch would not deliver any instruction this cycle
+    bool isBlocked() const {
+        if (missInstID) {
+#ifdef SESC_MISPATH
+            return false; // Fetches down the wrong path
+#else
+            return true;
+#endif
+        }
+        return flow.isStalled();
+    }
+    // Accounts for n cycles in which fetch was attempted while blocked
+    void addBlockedFetches(long long n) {
+        if (missInstID == 0)
+            nGradInsts += n; // realFetch counts every attempt
+    }
+
     static void setnInst2Sim(long long a) {
         nInst2Sim = a;
     }
@@ -24,6 +24,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include <math.h>
 #include "GMemorySystem.h"
+#include "MemRequest.h"
 
 ushort GMemorySystem::Log2PageSize=0;
 uint32_t GMemorySystem::PageMask;
@@ -140,6 +141,22 @@ MemObj *GMemorySystem::buildMemoryObj(const char *type, const char *section, con
     return new DummyMemObj(section, name);
 }
 
+///
+// Number of levels a request can go down from obj
+static size_t getPathDepth(const MemObj *obj, size_t limit)
+{
+    size_t depth = 0;
+    const MemObj::LevelType *lower = obj->getLowerLevel();
+    if (limit == 0)
+        return 0;
+    for(size_t i=0; i<lower->size(); i++) {
+        size_t d = 1 + getPathDepth((*lower)[i], limit-1);
+        if (d > depth)
+            depth = d;
+    }
+    return depth;
+}
+
 void GMemorySystem::buildMemorySystem()
 {
     SescConf->isCharPtr("", "cpucore", Id);
@@ -159,6 +176,11 @@ void GMemorySystem::buildMemorySystem()
     }
 
     memoryOS = buildMemoryOS(def_block);
+
+    if (dataSource)
+        MemRequest::setMaxPathDepth(getPathDepth(dataSource, 64));
+    if (instrSource)
+        MemRequest::setMaxPathDepth(getPathDepth(instrSource, 64));
 }
 
 char *GMemorySystem::buildUniqueName(const char *device_type)
@@ -33,6 +33,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "GMemoryOS.h"
 #include "GMemorySystem.h"
 #include "LDSTBuffer.h"
+#include "SimProfiler.h"
 
 
 GProcessor::GProcessor(GMemorySystem *gm, CPU_t i, size_t numFlows)
@@ -54,6 +55,11 @@ GProcessor::GProcessor(GMemorySystem *gm, CPU_t i, size_t numFlows)
 #if (defined DEBUG)
     ,prevDInstID(0)
 #endif
+    ,nextProfileSample(0)
+    ,profileDue(false)
+    ,profilePC(0)
+    ,lastRetiredPid(-1)
+    ,lastRetiredPC(0)
     ,noFetch("Processor(%d)_noFetch", i)
     ,noFetch2("Processor(%d)_noFetch2", i)
     ,retired("ExeEngine(%d)_retired", i)
@@ -434,6 +440,7 @@ void GProcessor::replay(DInst *dinst)
 
 void GProcessor::report(const char *str)
 {
+    wakeUp();
     Report::field("Proc(%d):clockTicks=%lld", Id, clockTicks);
     memorySystem->getMemoryOS()->report(str);
 }
@@ -471,6 +478,10 @@ void GProcessor::retire()
 
     robUsed.sample(ROB.size());
 
+    bool profiling = SimProfiler::isActive();
+    if(profiling && globalClock >= nextProfileSample)
+        startProfileSample();
+
     ushort i;
 
     for(i=0; i<RetireWidth && !ROB.empty(); i++) {
@@ -486,6 +497,11 @@ void GProcessor::retire()
 
         bool fake = dinst->isFake();
 
+        if(profiling) {
+            lastRetiredPid = dinst->context->getPid();
+            lastRetiredPC  = dinst->getInst()->getAddr();
+        }
+
         I(dinst->getResource());
         RetOutcome retOutcome = dinst->getResource()->retire(dinst);
         if( retOutcome != Retired) {
@@ -508,5 +524,71 @@ void GProcessor::retire()
     if(!ROB.empty() || i != 0)
         addStatsRetire(i);
 
+    if(profileDue)
+        endProfileSample(Retired);
+}
+
+void GProcessor::startProfileSample()
+{
+    nextProfileSample = globalClock + SimProfiler::getInterval();
+
+    if(ROB.empty()) {
+        FetchEngine *fe = currentFlow();
+        if(fe && fe->getPid() >= 0) {
+            ThreadContext *context = ThreadContext::getContext(fe->getPid());
+            SimProfiler::sample(context, committedPC(context), SimProfiler::NoInst);
+        }
+        return;
+    }
+
+    const DInst *head = ROB.top();
+    profileContext = head->context;
+    profilePC      = static_cast<uint32_t>(head->getInst()->getAddr());
+    profileDue     = true;
+}
+
+void GProcessor::endProfileSample(int32_t cause)
+{
+    profileDue = false;
+    SimProfiler::sample(profileContext, profilePC, cause);
+    profileContext = 0;
+}
+
+// With run-ahead emulation the thread's own PC is ahead of fetch, so an
+// empty ROB is charged to the last instruction the thread retired here, or,
+// if it has not retired any since it arrived, to the next one it will fetch
+VAddr GProcessor::committedPC(ThreadContext *context) const
+{
+    if(context->getPid() == lastRetiredPid)
+        return lastRetiredPC;
+    if(context->hasRunAhead())
+        return context->getRunAhead(0)->top().inst->getAddr();
+    return context->getIAddr();
+}
+
+void GProcessor::creditProfileSamples(Time_t nSkipped)
+{
+    if(!SimProfiler::isActive())
+        return;
+
+    // The schedule may be stale if retire has not run yet
+    if(nextProfileSample + nSkipped < globalClock)
+        nextProfileSample = globalClock - nSkipped;
+
+    // Nothing changed in the skipped cycles: the ROB head, if any, was
+    // waiting to execute the whole time
+    while(nextProfileSample < globalClock) {
+        if(ROB.empty()) {
+            FetchEngine *fe = currentFlow();
+            if(fe && fe->getPid() >= 0) {
+                ThreadContext *context = ThreadContext::getContext(fe->getPid());
+                SimProfiler::sample(context, committedPC(context), SimProfiler::NoInst);
+            }
+        } else {
+            const DInst *head = ROB.top();
+            SimProfiler::sample(head->context, head->getInst()->getAddr(), NotExecuted);
+        }
+        nextProfileSample += SimProfiler::getInterval();
+    }
 }
 
@@ -95,6 +95,22 @@ protected:
 
     ID(int32_t prevDInstID);
 
+    // SimProfiler state: the ROB head of a sampled cycle is only charged
+    // once retire knows why it did or did not leave
+    Time_t                 nextProfileSample;
+    bool                   profileDue;
+    ThreadContext::pointer profileContext;
+    VAddr                  profilePC;
+    // Last instruction retired, charged for the cycles the ROB is empty
+    Pid_t                  lastRetiredPid;
+    VAddr                  lastRetiredPC;
+    void startProfileSample();
+    void endProfileSample(int32_t cause);
+    VAddr committedPC(ThreadContext *context) const;
+    // Take the samples that fell in the last nSkipped cycles, in which
+    // retire did not run
+    void creditProfileSamples(Time_t nSkipped);
+
     GStatsCntr *nStall[MaxStall];
     GStatsCntr *nInst[MaxInstType];
 #ifdef SESC_MISPATH
@@ -144,6 +160,9 @@ protected:
 
         notRetired[Self][dinst->getInst()->getOpcode()][cause]->inc();
         notRetired[Other][dinst->getInst()->getOpcode()][cause]->add(RetireWidth - index - 1);
+
+        if(profileDue)
+            endProfileSample(index == 0 ? cause : Retired);
     }
 
 public:
@@ -204,6 +223,10 @@ public:
     // Processor.
     virtual void advanceClock() = 0;
 
+    // Cores that skip idle cycles credit them here, so that clockTicks and
+    // the per-cycle stats are up to date
+    virtual void wakeUp() { }
+
     virtual bool hasWork() const=0;
 
 
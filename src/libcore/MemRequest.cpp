@@ -43,6 +43,8 @@ pool<ReqPathEntry> ReqPathEntry::pPool(4096, "ReqPathEntry");
 /************************************************
  *        MemRequest
  ************************************************/
+size_t MemRequest::maxPathDepth = 0;
+
 MemRequest::MemRequest()
     :accessCB(this)
     ,returnAccessCB(this)
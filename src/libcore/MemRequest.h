@@ -24,9 +24,9 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define MEMREQUEST_H
 
 #include <vector>
-#include <stack>
 
 #include "nanassert.h"
+#include "InlineStack.h"
 #include "libll/ThreadContext.h"
 #include "Resource.h"
 #include "Cluster.h"
@@ -114,9 +114,18 @@ protected:
     // Called through callback
     void access();
     void returnAccess();
-    std::stack<MemObj*> memStack;
 
-    std::stack<Time_t>  clockStack;
+    // Route through the hierarchy: the object to return to, and the clock
+    // when the request left it. Kept inline so goDown/goUp never allocate.
+    struct PathEntry {
+        MemObj *memObj;
+        Time_t  clock;
+    };
+    enum { InlinePathDepth = 8 };
+    InlineStack<PathEntry, InlinePathDepth> memStack;
+    // Deepest path allowed by the configuration, used to size the spill area
+    static size_t maxPathDepth;
+
     Time_t currentClockStamp;
 
     DInst *dinst;
@@ -235,9 +244,31 @@ public:
         return wToRLevel != -1 || memOp == MemWrite;
     }
 
+    static void setMaxPathDepth(size_t depth) {
+        if (depth > maxPathDepth)
+            maxPathDepth = depth;
+    }
+
+private:
+    void pushPath() {
+        if (memStack.size() == InlinePathDepth)
+            memStack.reserve(maxPathDepth);
+        PathEntry e;
+        e.memObj = currentMemObj;
+        e.clock  = globalClock;
+        memStack.push(e);
+    }
+    void popPath() {
+        const PathEntry &e = memStack.top();
+        currentMemObj     = e.memObj;
+        currentClockStamp = e.clock;
+        memStack.pop();
+    }
+
+public:
+
     void goDown(TimeDelta_t lat, MemObj *newMemObj) {
-        memStack.push(currentMemObj);
-        clockStack.push(globalClock);
+        pushPath();
 #ifdef SESC_SMP_DEBUG
         registerVisit(currentMemObj, "goDown", globalClock);
 #endif
@@ -246,8 +277,7 @@ public:
     }
 
     void goDownAbs(Time_t time, MemObj *newMemObj) {
-        memStack.push(currentMemObj);
-        clockStack.push(globalClock);
+        pushPath();
 #ifdef SESC_SMP_DEBUG
         registerVisit(currentMemObj, "goDownAbs", globalClock);
 #endif
@@ -261,16 +291,14 @@ public:
 
 #if (defined SESC_CMP) 
     void stitchMemObj(MemObj *obj) {
-        MemObj *t = memStack.top();
-        memStack.pop();
-        memStack.push(obj);
+        memStack.top().memObj = obj;
     }
 
 	MemObj* getMemStackTop() {
 		if(memStack.empty()) {
 			return NULL;
 		}
-		return memStack.top();
+		return memStack.top().memObj;
 	}
 #endif
     void goUp(TimeDelta_t lat) {
@@ -285,12 +313,7 @@ public:
         registerVisit(currentMemObj, "goUp", globalClock);
 #endif
 
-        currentMemObj = memStack.top();
-        memStack.pop();
-
-        I(!clockStack.empty());
-        currentClockStamp = clockStack.top();
-        clockStack.pop();
+        popPath();
 
         returnAccessCB.schedule(lat);
     }
@@ -306,12 +329,7 @@ public:
         registerVisit(currentMemObj, "goUpAbs", globalClock);
 #endif
 
-        currentMemObj = memStack.top();
-        memStack.pop();
-
-        I(!clockStack.empty());
-        currentClockStamp = clockStack.top();
-        clockStack.pop();
+        popPath();
 
         returnAccessCB.scheduleAbs(time);
     }
@@ -41,6 +41,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "GProcessor.h"
 #include "FetchEngine.h"
 #include "EventTrace.h"
+#include "SimProfiler.h"
+#include "StatsEpoch.h"
 
 #if (defined SESC_CMP)
 #include "libcmp/SMPCache.h"
@@ -55,6 +57,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #endif
 
 #include "libll/ThreadStats.h"
+#include "libll/SpinWait.h"
 #include "libll/ThreadContext.h"
 #include "OSSim.h"
 
@@ -115,6 +118,15 @@ void OSSim::reportOnTheFly(const char *file)
     free(tmp);
 }
 
+void OSSim::wakeUpCPUs()
+{
+    for(size_t i = 0; i < cpus.size(); i++) {
+        GProcessor *gproc = cpus.getProcessor(i);
+        if(gproc)
+            gproc->wakeUp();
+    }
+}
+
 OSSim::OSSim(int32_t argc, char **argv, char **envp)
     : traceFile(0)
     ,snapshotGlobalClock(0)
@@ -432,6 +444,22 @@ void OSSim::processParams(int32_t argc, char **argv, char **envp)
         EventTrace::openFile("datafile.out");
     }
 
+    if (SescConf->checkInt("","profileInterval")) {
+        SescConf->isBetween("","profileInterval",0,1<<30);
+        int32_t profileInterval = SescConf->getInt("","profileInterval");
+        if (profileInterval > 0) {
+            char *profileFile = (char *)malloc(strlen(finalReportFile) + 8);
+            sprintf(profileFile, "%s.folded", finalReportFile);
+            SimProfiler::openFile(profileFile, profileInterval);
+            free(profileFile);
+        }
+    }
+
+    if (SescConf->checkInt("","statsEpochTxns")) {
+        SescConf->isBetween("","statsEpochTxns",0,1<<30);
+        StatsEpoch::setTxnsPerEpoch(SescConf->getInt("","statsEpochTxns"));
+    }
+
     free(finalReportFile);
 
 #ifdef SESC_THERM
@@ -780,6 +808,8 @@ void OSSim::initBoot()
     else
         NoMigration = false;
 
+    SpinWait::boot();
+
     // this is only necessary when running execution-driven
 
     // Launch the boot flow
@@ -857,6 +887,7 @@ void OSSim::simFinish()
 
 #if (defined SESC_CMP)
 	SMPCache::PrintStat();
+	SMPCache::writeHomeProfile();
 	SMPNOC::PrintStat();
 #endif
 #if (defined DRAMSIM2)
@@ -864,6 +895,11 @@ void OSSim::simFinish()
 #endif
 
     EventTrace::close();
+    SimProfiler::close();
+
+#if (defined TM)
+    htmManager->finish();
+#endif
 
     // hein? what is this? merge problems?
     //  if(trace())
@@ -875,6 +911,9 @@ void OSSim::report(const char *str)
 
     ProcessId::report(str);
     ThreadStats::report(str);
+#if (defined TM)
+    htmManager->report(str);
+#endif
 
     for(size_t i=0; i<cpus.size(); i++) {
         GProcessor *gproc = cpus.getProcessor(i);
@@ -934,6 +973,8 @@ void OSSim::report(const char *str)
     Report::field("EnergyMgr:totEnergy=%g",EnergyMgr::ptoe(totPower));
 #endif
 
+    StatsEpoch::report();
+
     // GStats must be the last to be called because previous ::report
     // can update statistics
     GStats::report(str);
@@ -312,6 +312,9 @@ public:
     void stopSimulation() {
         cpus.finishWorkNow();
     }
+    // Dormant cores credit their skipped cycles when they wake up. Call it
+    // before any GStats::reset so that those cycles land before the reset.
+    void wakeUpCPUs();
     void switchOut(CPU_t id, ProcessId *procId) {
         cpus.switchOut(id, procId);
     }
@@ -62,6 +62,7 @@ Pipeline::Pipeline(size_t s, size_t fetch, int32_t maxReqs)
     minItemCntr = 0;
 
     nCleanMarks = 0;
+    nFullRequests = 0;
 
     bucketPool.reserve(bucketPoolMaxSize);
     I(bucketPool.empty());
@@ -129,10 +130,13 @@ void Pipeline::readyItem(IBucket *b)
     // receive structure (remember that a cache can respond
     // out-of-order the memory requests)
     minItemCntr++;
-    if( b->empty() )
+    if( b->empty() ) {
         doneItem(b);
-    else
+    } else {
+        if (!b->cleanItem)
+            nFullRequests--;
         buffer.push(b);
+    }
 
     clearItems(); // Try to insert on minItem reveiced (OoO) buckets
 }
@@ -148,10 +152,13 @@ void Pipeline::clearItems()
         received.pop();
 
         minItemCntr++;
-        if( b->empty() )
+        if( b->empty() ) {
             doneItem(b);
-        else
+        } else {
+            if (!b->cleanItem)
+                nFullRequests--;
             buffer.push(b);
+        }
     }
 }
 
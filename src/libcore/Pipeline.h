@@ -105,6 +105,9 @@ private:
 
     int32_t nCleanMarks;
 
+    // Buckets holding instructions that were fetched but are not in buffer yet
+    int32_t nFullRequests;
+
 protected:
     void clearItems();
 public:
@@ -135,6 +138,19 @@ public:
         // bucketPool.size() has lineal time O(n)
         return !buffer.empty() || !received.empty() || nIRequests < MaxIRequests;
     }
+    // Called once the fetch engine filled a bucket from newItem
+    void sentItem(const IBucket *b) {
+        if (!b->empty())
+            nFullRequests++;
+    }
+    // True if nextItem may return a bucket now or in a later cycle. Unlike
+    // hasOutstandingItems, empty buckets still in flight do not count.
+    bool hasPendingInsts() const {
+        return !buffer.empty() || nFullRequests > 0;
+    }
+    bool canNewItem() const {
+        return nIRequests > 0 && !bucketPool.empty();
+    }
     void readyItem(IBucket *b);
     void doneItem(IBucket *b) {
         I(b->getPipelineId() < minItemCntr);
@@ -41,6 +41,12 @@ Processor::Processor(GMemorySystem *gm, CPU_t i)
     :GProcessor(gm, i, 1)
     ,IFID(i, i, gm, this)
     ,pipeQ(i)
+    ,dormantMode(SescConf->checkBool("cpucore", "dormantMode", i)
+                 && SescConf->getBool("cpucore", "dormantMode", i))
+    ,dormant(false)
+    ,dormantEffects(0)
+    ,nDormantCycles(0)
+    ,dormantCycles("Processor(%d):dormantCycles", i)
 {
     spaceInInstQueue = InstQueueSize;
 
@@ -68,11 +74,13 @@ FetchEngine *Processor::currentFlow()
 
 void Processor::switchIn(Pid_t pid)
 {
+    wakeUp();
     IFID.switchIn(pid);
 }
 
 void Processor::switchOut(Pid_t pid)
 {
+    wakeUp();
     IFID.switchOut(pid);
 }
 
@@ -85,6 +93,8 @@ long long Processor::getAndClearnGradInsts(Pid_t pid)
 {
     I(IFID.getPid() == pid);
 
+    wakeUp();
+
     return IFID.getAndClearnGradInsts();
 }
 
@@ -116,6 +126,18 @@ void Processor::advanceClock()
     }   
 #endif
 
+    if (dormantMode) {
+        int32_t effects = getDormantEffects();
+        if (dormant && effects != dormantEffects)
+            wakeUp();
+        if (effects >= 0) {
+            dormant        = true;
+            dormantEffects = effects;
+            nDormantCycles++;
+            return;
+        }
+    }
+
     clockTicks++;
 
     //  GMSG(!ROB.empty(),"robTop %d Ul %d Us %d Ub %d",ROB.getIdFromTop(0)
@@ -126,6 +148,7 @@ void Processor::advanceClock()
         IBucket *bucket = pipeQ.pipeLine.newItem();
         if( bucket ) {
             IFID.fetch(bucket);
+            pipeQ.pipeLine.sentItem(bucket);
         }
     }
 
@@ -154,6 +177,83 @@ void Processor::advanceClock()
     retire();
 }
 
+///
+// Returns -1 if advanceClock could change the core state this cycle.
+// Otherwise the cycle would only update per-cycle stats, and the result says
+// which ones (DormantEffect bits). Nothing here can change until an event
+// (memory response, branch resolution, stall expiry, context switch) does it.
+int32_t Processor::getDormantEffects() const
+{
+    int32_t effects = 0;
+
+    // Retire
+    if (!ROB.empty()) {
+        if (ROB.top()->isExecuted())
+            return -1;
+        effects |= DormantRetireStall;
+    }
+
+    // Rename (only a full ROB is sure to stall until the head retires)
+    if (!pipeQ.instQueue.empty()) {
+        if (InOrderCore || !replayQ.empty() || ROB.size() < MaxROBSize)
+            return -1;
+        effects |= DormantIssueStall;
+    }
+
+    // ID Stage
+    if (spaceInInstQueue >= FetchWidth) {
+        if (pipeQ.pipeLine.hasPendingInsts())
+            return -1;
+        effects |= DormantNoFetch2;
+    }
+
+    // Fetch Stage
+    if (IFID.hasWork() && pipeQ.pipeLine.canNewItem()) {
+        if (!IFID.isBlocked())
+            return -1;
+        effects |= DormantFetchStall;
+    }
+
+    return effects;
+}
+
+///
+// Credit the cycles skipped while dormant with what advanceClock would have
+// counted in each of them.
+void Processor::wakeUp()
+{
+    if (!dormant)
+        return;
+
+    long long n = nDormantCycles;
+
+    creditProfileSamples(n);
+
+    clockTicks += n;
+    dormantCycles.add(n);
+
+    if (dormantEffects & DormantFetchStall)
+        IFID.addBlockedFetches(n);
+
+    if (dormantEffects & DormantNoFetch2)
+        noFetch2.add(n);
+    else
+        noFetch.add(n);
+
+    if (dormantEffects & DormantIssueStall)
+        nStall[SmallROBStall]->add(RealisticWidth * n);
+
+    robUsed.msamples(ROB.size() * n, n);
+    if (dormantEffects & DormantRetireStall) {
+        InstType op = ROB.top()->getInst()->getOpcode();
+        retired.msamples(0, n);
+        notRetired[Self][op][NotExecuted]->add(n);
+        notRetired[Other][op][NotExecuted]->add((RetireWidth - 1) * n);
+    }
+
+    dormant        = false;
+    nDormantCycles = 0;
+}
 
 StallCause Processor::addInst(DInst *dinst)
 {
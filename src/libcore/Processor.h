@@ -41,6 +41,22 @@ private:
 
     DInst *RAT[NumArchRegs];
 
+    // Dormant mode: cycles in which the core cannot make progress are
+    // skipped, and their per-cycle stats are credited in bulk on wakeup
+    enum DormantEffect {
+        DormantFetchStall   = 1, // Fetch attempted on a blocked flow
+        DormantNoFetch2     = 2, // ID stage had nothing to decode
+        DormantIssueStall   = 4, // Issue stalled on a full ROB
+        DormantRetireStall  = 8  // ROB head not executed
+    };
+    const bool dormantMode;
+    bool       dormant;
+    int32_t    dormantEffects;
+    Time_t     nDormantCycles;
+    GStatsCntr dormantCycles;
+
+    int32_t getDormantEffects() const;
+
 protected:
 
 
@@ -62,6 +78,7 @@ protected:
     bool hasWork() const;
 
     void advanceClock();
+    void wakeUp();
 
     StallCause addInst(DInst *dinst);
 
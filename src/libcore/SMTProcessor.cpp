@@ -225,6 +225,7 @@ void SMTProcessor::advanceClock()
             IBucket *bucket = flow[cFetchId]->pipeQ.pipeLine.newItem();
             if( bucket ) {
                 flow[cFetchId]->IFID.fetch(bucket, fetchMax);
+                flow[cFetchId]->pipeQ.pipeLine.sentItem(bucket);
                 // readyItem will be called once the bucket is fetched
                 nFetched += bucket->size();
                 fetchDist.sample(cFetchId, bucket->size());
@@ -0,0 +1,82 @@
+#include <string>
+
+#include "nanassert.h"
+#include "SimProfiler.h"
+#include "libll/ThreadContext.h"
+
+FILE                   *SimProfiler::fd       = 0;
+Time_t                  SimProfiler::interval = 0;
+SimProfiler::SampleMap  SimProfiler::samples;
+std::map<AddressSpace *, AddressSpace::pointer> SimProfiler::spaces;
+
+static const char *causeNames[SimProfiler::MaxCause] = {
+    "Retired",
+    "NotExecuted",
+    "NotFinished",
+    "NoCacheSpace",
+    "NoCachePorts",
+    "WaitForFence",
+    "NoInst"
+};
+
+void SimProfiler::openFile(const char *name, Time_t ival)
+{
+    I(fd == 0);
+    fd = fopen(name, "w");
+    if(fd == 0) {
+        fprintf(stderr, "SimProfiler: could not open file [%s]\n", name);
+        exit(-3);
+    }
+    interval = ival;
+}
+
+void SimProfiler::sample(ThreadContext *context, VAddr pc, int32_t cause)
+{
+    I(cause < MaxCause);
+    AddressSpace *space = context->getAddressSpace();
+    if(spaces.find(space) == spaces.end())
+        spaces[space] = space;
+
+    Key key;
+    key.space = space;
+    key.pid   = context->getPid();
+    key.cause = cause;
+    key.pc    = pc;
+    samples[key]++;
+}
+
+void SimProfiler::close()
+{
+    if(fd == 0)
+        return;
+
+    // Samples are sorted by PC within each thread, so each function is
+    // looked up once per run of PCs rather than once per sample
+    std::map<std::string, uint64_t> folded;
+    AddressSpace *lastSpace = 0;
+    VAddr funcBeg = 0;
+    VAddr funcEnd = 0;
+    std::string funcName;
+    for(SampleMap::const_iterator it = samples.begin(); it != samples.end(); it++) {
+        const Key &key = it->first;
+        if(key.space != lastSpace || key.pc < funcBeg || key.pc >= funcEnd) {
+            lastSpace = key.space;
+            if(key.space->findFunc(key.pc, funcBeg, funcEnd))
+                funcName = key.space->getFuncName(funcBeg);
+            else
+                funcName = "[unknown]";
+        }
+        char prefix[32];
+        sprintf(prefix, "P%d;", (int)key.pid);
+        folded[prefix + funcName + ";" + causeNames[key.cause]] += it->second;
+    }
+
+    for(std::map<std::string, uint64_t>::const_iterator it = folded.begin(); it != folded.end(); it++)
+        fprintf(fd, "%s %llu\n", it->first.c_str(), (unsigned long long)it->second);
+
+    fclose(fd);
+    fd = 0;
+    interval = 0;
+    samples.clear();
+    spaces.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef SIMPROFILER_H
+#define SIMPROFILER_H
+
+#include <stdio.h>
+#include <map>
+
+#include "Snippets.h"
+#include "Resource.h"
+#include "libemul/AddressSpace.h"
+
+class ThreadContext;
+
+///
+// Sampling profiler of simulated code. Every profileInterval cycles each
+// processor charges the cycle to the instruction at the head of its ROB and
+// to the reason it did (or did not) retire. PCs are only turned into function
+// names when the profile is written, as one folded-stack line per thread,
+// function and cause ("P<pid>;<function>;<cause> <samples>"), which flame
+// graph tools read directly.
+class SimProfiler {
+public:
+    // Cause for a cycle in which the ROB was empty
+    enum {
+        NoInst = MaxRetOutcome,
+        MaxCause
+    };
+
+    static void openFile(const char *name, Time_t interval);
+    static void close();
+
+    static bool isActive() {
+        return interval != 0;
+    }
+    static Time_t getInterval() {
+        return interval;
+    }
+
+    static void sample(ThreadContext *context, VAddr pc, int32_t cause);
+
+private:
+    struct Key {
+        AddressSpace *space;
+        Pid_t         pid;
+        int32_t       cause;
+        VAddr         pc;
+        bool operator<(const Key &other) const {
+            if(space!=other.space)
+                return space<other.space;
+            if(pid!=other.pid)
+                return pid<other.pid;
+            if(pc!=other.pc)
+                return pc<other.pc;
+            return cause<other.cause;
+        }
+    };
+    typedef std::map<Key, uint64_t> SampleMap;
+
+    static FILE        *fd;
+    static Time_t       interval;
+    static SampleMap    samples;
+    // Keeps the address spaces of exited threads for the final symbol lookup
+    static std::map<AddressSpace *, AddressSpace::pointer> spaces;
+};
+
+#endif // SIMPROFILER_H
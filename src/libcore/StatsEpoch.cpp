@@ -0,0 +1,49 @@
+#include <stdio.h>
+
+#include "GStats.h"
+#include "ReportGen.h"
+#include "StatsEpoch.h"
+#include "OSSim.h"
+#include "libll/ThreadContext.h"
+
+int32_t StatsEpoch::nEpochs      = 0;
+Time_t  StatsEpoch::epochBegin   = 0;
+int32_t StatsEpoch::txnsPerEpoch = 0;
+int32_t StatsEpoch::nTxns        = 0;
+
+void StatsEpoch::mark(int32_t tag)
+{
+    close("mark", tag);
+}
+
+void StatsEpoch::close(const char *cause, int32_t tag)
+{
+    nTxns = 0;
+
+    // Nothing is being measured while fast forwarding
+    if(ThreadContext::ff)
+        return;
+
+    char name[32];
+    sprintf(name, "Epoch%d", nEpochs);
+
+    // Dormant cycles so far belong to this epoch
+    osSim->wakeUpCPUs();
+
+    Report::field("StatsEpoch:name=%s:cause=%s:tag=%d:begin=%lld:end=%lld"
+                  ,name, cause, tag, epochBegin, globalClock);
+    GStats::report(name);
+    GStats::reset();
+
+    nEpochs++;
+    epochBegin = globalClock;
+}
+
+void StatsEpoch::report()
+{
+    if(nEpochs == 0)
+        return;
+
+    // The GStats that follow only cover the cycles since the last epoch
+    Report::field("StatsEpoch:nEpochs=%d:lastBegin=%lld", nEpochs, epochBegin);
+}
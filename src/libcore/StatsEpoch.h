@@ -0,0 +1,43 @@
+#ifndef STATSEPOCH_H
+#define STATSEPOCH_H
+
+#include <stdint.h>
+
+#include "Snippets.h"
+
+///
+// Statistics epochs, to get per-phase numbers out of one run. Markers in the
+// simulated program close the current epoch: the stats epoch magic
+// instruction (pref hint 16, whose address operand tags the epoch), and,
+// when statsEpochTxns is set, every statsEpochTxns committed outermost
+// transactions. Closing an epoch writes every GStats to the report file as
+// "GStats::report Epoch<n>" and resets them, so each epoch holds the deltas
+// of its own phase and the final report those of the last one.
+class StatsEpoch {
+public:
+    static void setTxnsPerEpoch(int32_t n) {
+        txnsPerEpoch = n;
+    }
+
+    // The simulated program executed the stats epoch marker
+    static void mark(int32_t tag);
+    // An outermost transaction committed
+    static void txnCommitted() {
+        if(txnsPerEpoch == 0)
+            return;
+        if(++nTxns >= txnsPerEpoch)
+            close("txns", nTxns);
+    }
+
+    static void report();
+
+private:
+    static void close(const char *cause, int32_t tag);
+
+    static int32_t nEpochs;
+    static Time_t  epochBegin;
+    static int32_t txnsPerEpoch;
+    static int32_t nTxns;
+};
+
+#endif // STATSEPOCH_H
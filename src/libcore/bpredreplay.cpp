@@ -0,0 +1,127 @@
+/*
+ * Replays a branch trace recorded by FetchEngine (cpucore:bpredTrace) through
+ * several branch predictor configurations at once, one host thread per
+ * predictor, and prints the MPKI of each.
+ *
+ * bpredreplay -c sesc.conf [-w fetchWidth] [-j threads] trace section...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "SescConf.h"
+#include "BPred.h"
+#include "BPredTrace.h"
+
+struct ReplayResult {
+    const char *section;
+    BPredictor *bpred;
+    long long   nBranches;
+    long long   nMiss;
+};
+
+static std::vector<BPredTrace::Record> trace;
+static long long nInsts = 0;
+
+static void loadTrace(const char *fname)
+{
+    BPredTraceReader reader(fname);
+    BPredTrace::Record r;
+    while(reader.next(r)) {
+        nInsts += r.nInsts;
+        if(r.subCode != BPredTrace::EndMark)
+            trace.push_back(r);
+    }
+}
+
+static void replay(ReplayResult &res)
+{
+    Instruction inst;
+    for(size_t i = 0; i < trace.size(); i++) {
+        BPredTrace::toInstruction(trace[i], inst);
+
+        PredType p = res.bpred->predict(&inst, trace[i].oracleID, true);
+        res.nBranches++;
+        if(p != CorrectPrediction)
+            res.nMiss++;
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: bpredreplay -c sesc.conf [-w fetchWidth] [-j threads] trace section...\n");
+    exit(1);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const char *confName = 0;
+    int32_t fetchWidth = 4;
+    int32_t nThreads = std::thread::hardware_concurrency();
+
+    int32_t c;
+    while((c = getopt(argc, argv, "c:w:j:")) != -1) {
+        switch(c) {
+        case 'c':
+            confName = optarg;
+            break;
+        case 'w':
+            fetchWidth = atoi(optarg);
+            break;
+        case 'j':
+            nThreads = atoi(optarg);
+            break;
+        default:
+            usage();
+        }
+    }
+    if(confName == 0 || argc - optind < 2 || fetchWidth <= 0)
+        usage();
+    if(nThreads <= 0)
+        nThreads = 1;
+
+    SescConf = new SConfig(confName);
+
+    loadTrace(argv[optind]);
+
+    // Predictors register their statistics when built, so build them here
+    std::vector<ReplayResult> results;
+    for(int32_t i = optind + 1; i < argc; i++) {
+        ReplayResult res;
+        res.section   = argv[i];
+        res.bpred     = new BPredictor(results.size(), fetchWidth, argv[i]);
+        res.nBranches = 0;
+        res.nMiss     = 0;
+        results.push_back(res);
+    }
+
+    // Each predictor only touches its own state, so they replay concurrently
+    std::atomic<size_t> nextPred(0);
+    std::vector<std::thread> workers;
+    for(int32_t t = 0; t < nThreads && t < (int32_t)results.size(); t++) {
+        workers.push_back(std::thread([&results, &nextPred] {
+            size_t i;
+            while((i = nextPred++) < results.size())
+                replay(results[i]);
+        }));
+    }
+    for(size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    printf("# %lld instructions, %lu branches\n", nInsts, (unsigned long)trace.size());
+    printf("# section\tnBranches\tnMiss\tmissRate\tMPKI\n");
+    for(size_t i = 0; i < results.size(); i++) {
+        const ReplayResult &res = results[i];
+        printf("%s\t%lld\t%lld\t%.4f\t%.4f\n", res.section, res.nBranches, res.nMiss
+               ,res.nBranches ? (double)res.nMiss / res.nBranches : 0.0
+               ,nInsts ? 1000.0 * res.nMiss / nInsts : 0.0);
+    }
+
+    return 0;
+}
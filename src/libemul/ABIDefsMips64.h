@@ -333,6 +333,7 @@ public:
         typedef Tsize_t Type_iov_len;
         static const size_t Offs_iov_len=8;
     };
+    static const Tint V__NR_readv = 0x0000139a;
     static const Tint V__NR_writev = 0x0000139b;
     typedef int64_t  Toff_t;
     typedef int64_t  Tloff_t;
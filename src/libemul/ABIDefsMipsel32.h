@@ -334,6 +334,7 @@ public:
         typedef Tsize_t Type_iov_len;
         static const size_t Offs_iov_len=4;
     };
+    static const Tint V__NR_readv = 0x00001031;
     static const Tint V__NR_writev = 0x00001032;
     typedef int32_t  Toff_t;
     typedef int64_t  Tloff_t;
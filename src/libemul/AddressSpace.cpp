@@ -1,6 +1,7 @@
 #include <sys/mman.h>
 #include "AddressSpace.h"
 #include "nanassert.h"
+#include <algorithm>
 
 #include <cstring>
 
@@ -12,6 +13,44 @@ FrameDesc::PAddrSet FrameDesc::freePAddrs;
 
 FrameDesc::FileToFrame FrameDesc::fileToFrame;
 
+FrameDesc::DataList FrameDesc::freeData;
+int8_t *FrameDesc::arenaNext=0;
+int8_t *FrameDesc::arenaEnd=0;
+
+// Pages in each host allocation of frame storage (2MB, one huge page)
+#define FrameArenaPages (512)
+
+MemAlignType *FrameDesc::newData(bool zero) {
+    if(!freeData.empty()) {
+        MemAlignType *ptr=freeData.back();
+        freeData.pop_back();
+        if(zero)
+            memset(ptr,0,AddrSpacPageSize);
+        return ptr;
+    }
+    if(arenaNext==arenaEnd) {
+        size_t len=FrameArenaPages*AddrSpacPageSize;
+        void *addr=mmap(0,len,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+        if(addr==MAP_FAILED)
+            fail("FrameDesc::newData could not allocate %ld bytes\n",(long)len);
+#if (defined MADV_HUGEPAGE)
+        madvise(addr,len,MADV_HUGEPAGE);
+#endif
+        arenaNext=static_cast<int8_t *>(addr);
+        arenaEnd=arenaNext+len;
+    }
+    // Fresh anonymous memory is already zero
+    MemAlignType *ptr=reinterpret_cast<MemAlignType *>(arenaNext);
+    arenaNext+=AddrSpacPageSize;
+    return ptr;
+}
+void FrameDesc::delData(MemAlignType *ptr) {
+#if (defined DEBUG)
+    memset(ptr,0xCC,AddrSpacPageSize);
+#endif
+    freeData.push_back(ptr);
+}
+
 FrameDesc *FrameDesc::create(FileSys::SeekableDescription *fdesc, off_t offs) {
     FileMapKey key(fdesc,offs);
     FileToFrame::iterator it=fileToFrame.find(key);
@@ -28,19 +67,28 @@ void FrameDesc::sync(void) {
         dirty=false;
     }
 }
-FrameDesc::FrameDesc() : GCObject(), basePAddr(newPAddr()), shared(false), dirty(false), fileDesc(0) {
-    memset(data,0,AddrSpacPageSize);
+FrameDesc::FrameDesc() : GCObject(), basePAddr(newPAddr()), shared(false), dirty(false), mapped(false), fileDesc(0) {
+    data=newData(true);
 }
 FrameDesc::FrameDesc(FileSys::SeekableDescription *fdesc, off_t offs)
     : GCObject()
     , basePAddr(newPAddr())
     , shared(true)
     , dirty(false)
+    , mapped(false)
     , fileDesc(fdesc)
     , fileOff(offs) {
     if(offs%AddrSpacPageSize)
         fail("FrameDesc file mapping offset is not page-aligned\n");
-    fileDesc->mmap(data,AddrSpacPageSize,fileOff);
+    // Use the file's host mapping directly when possible. Private mappings
+    // of the page get WrCopy, so stores from those copy the frame first.
+    data=static_cast<MemAlignType *>(fileDesc->mapPage(AddrSpacPageSize,fileOff));
+    if(data) {
+        mapped=true;
+    } else {
+        data=newData(false);
+        fileDesc->mmap(data,AddrSpacPageSize,fileOff);
+    }
 #if (defined HAS_MEM_STATE)
     for(size_t s=0; s<AddrSpacPageSize/MemState::Granularity; s++)
         state[s]=src.state[s];
@@ -51,7 +99,10 @@ FrameDesc::FrameDesc(FrameDesc &src)
     ,basePAddr(newPAddr())
     ,shared(false)
     ,dirty(false)
+    ,mapped(false)
+    ,fileDesc(0)
 {
+    data=newData(false);
     memcpy(data,src.data,AddrSpacPageSize);
 #if (defined HAS_MEM_STATE)
     for(size_t s=0; s<AddrSpacPageSize/MemState::Granularity; s++)
@@ -64,7 +115,8 @@ FrameDesc::~FrameDesc() {
         fileToFrame.erase(FileMapKey(fileDesc,fileOff));
     I(freePAddrs.find(basePAddr)==freePAddrs.end());
     freePAddrs.insert(basePAddr);
-    memset(data,0xCC,AddrSpacPageSize);
+    if(!mapped)
+        delData(data);
 }
 void FrameDesc::save(ChkWriter &out) const {
     out.write(reinterpret_cast<const char *>(data),AddrSpacPageSize);
@@ -74,7 +126,8 @@ void FrameDesc::save(ChkWriter &out) const {
 #endif
     out<<endl;
 }
-FrameDesc::FrameDesc(ChkReader &in) {
+FrameDesc::FrameDesc(ChkReader &in) : mapped(false) {
+    data=newData(false);
     in.read(reinterpret_cast<char *>(data),AddrSpacPageSize);
 #if (defined HAS_MEM_STATE)
     for(size_t s=0; s<AddrSpacPageSize/MemState::Granularity; s++)
@@ -301,7 +354,9 @@ void AddressSpace::delInsts(VAddr begAddr, VAddr endAddr) {
 
 AddressSpace::AddressSpace(void) :
     GCObject(),
-    brkBase(0)
+    brkBase(0),
+    namesSorted(true),
+    addrToHandlerGen(~size_t(0))
 {
 }
 
@@ -309,10 +364,13 @@ AddressSpace::AddressSpace(AddressSpace &src) :
     GCObject(),
     segmentMap(src.segmentMap),
     pageTable(src.pageTable),
-    brkBase(src.brkBase)
+    brkBase(src.brkBase),
+    addrToHandlerGen(~size_t(0))
 {
-    for(NamesByAddr::const_iterator it=src.namesByAddr.begin(); it!=src.namesByAddr.end(); it++)
-        addFuncName(it->addr,it->func,it->file);
+    src.sortNames();
+    names=src.names;
+    namesByName=src.namesByName;
+    namesSorted=true;
 }
 
 AddressSpace::~AddressSpace(void) {
@@ -347,7 +405,11 @@ void AddressSpace::save(ChkWriter &out) const {
 //   }
 }
 
-AddressSpace::AddressSpace(ChkReader &in) {
+AddressSpace::AddressSpace(ChkReader &in) :
+    GCObject(),
+    namesSorted(true),
+    addrToHandlerGen(~size_t(0))
+{
     in >> "BrkBase " >> brkBase >> endl;
     while(true) {
         size_t _pageNum;
@@ -380,89 +442,141 @@ AddressSpace::AddressSpace(ChkReader &in) {
 //   }
 }
 
+const std::string *AddressSpace::internFile(const std::string &file) {
+    static std::set<std::string> files;
+    return &(*(files.insert(file).first));
+}
+
+void AddressSpace::sortNames(void) const {
+    if(namesSorted)
+        return;
+    std::sort(names.begin(),names.end());
+    names.erase(std::unique(names.begin(),names.end()),names.end());
+    namesByName.resize(names.size());
+    for(size_t i=0; i<names.size(); i++)
+        namesByName[i]=i;
+    const NameTable &table=names;
+    std::sort(namesByName.begin(),namesByName.end(),[&table](uint32_t i1, uint32_t i2) {
+        const NameEntry &e1=table[i1];
+        const NameEntry &e2=table[i2];
+        if(e1.func!=e2.func)
+            return (e1.func<e2.func);
+        if(e1.file!=e2.file)
+            return (*e1.file<*e2.file);
+        return (e1.addr<e2.addr);
+    });
+    namesSorted=true;
+    addrToHandlerGen=~size_t(0);
+}
+
+size_t AddressSpace::lowerName(VAddr addr) const {
+    sortNames();
+    return std::lower_bound(names.begin(),names.end(),addr,[](const NameEntry &e, VAddr a) {
+        return (e.addr<a);
+    })-names.begin();
+}
+
 // Add a new function name-address mapping
 void AddressSpace::addFuncName(VAddr addr, const std::string &func, const std::string &file) {
-    std::pair<NamesByAddr::iterator,bool> ins=namesByAddr.insert(NameEntry(addr,func,file));
-    if(ins.second)
-        namesByName.insert(&(*(ins.first)));
+    names.push_back(NameEntry(addr,func,internFile(file)));
+    namesSorted=false;
 }
 
 // Removes all existing function name mappings in a given address range
 void AddressSpace::delFuncNames(VAddr begAddr, VAddr endAddr) {
-    NamesByAddr::iterator begIt=namesByAddr.upper_bound(endAddr);
-    NamesByAddr::iterator endIt=begIt;
-    while(endIt->addr>=begAddr) {
-        namesByName.erase(&(*endIt));
-        endIt++;
-    }
-    namesByAddr.erase(begIt,endIt);
+    size_t begIdx=lowerName(begAddr);
+    size_t endIdx=begIdx;
+    while((endIdx<names.size())&&(names[endIdx].addr<endAddr))
+        endIdx++;
+    if(begIdx==endIdx)
+        return;
+    names.erase(names.begin()+begIdx,names.begin()+endIdx);
+    namesSorted=false;
 }
 
 
 // Return name of the function with given entry point
 const std::string &AddressSpace::getFuncName(VAddr addr) const {
-    NamesByAddr::const_iterator nameIt=namesByAddr.lower_bound(addr);
-    if(nameIt==namesByAddr.end())
+    size_t idx=lowerName(addr);
+    if(idx==names.size())
         fail("");
-    if(nameIt->addr!=addr)
+    if(names[idx].addr!=addr)
         fail("");
-    return nameIt->func;
+    return names[idx].func;
 }
 
 // Return name of the ELF file in which the function is, given the entry point
 const std::string &AddressSpace::getFuncFile(VAddr addr) const {
-    NamesByAddr::const_iterator nameIt=namesByAddr.lower_bound(addr);
-    if(nameIt==namesByAddr.end())
+    size_t idx=lowerName(addr);
+    if(idx==names.size())
         fail("");
-    if(nameIt->addr!=addr)
+    if(names[idx].addr!=addr)
         fail("");
-    return nameIt->func;
+    return *names[idx].file;
 }
 
 // Given the name, return where the function begins
 VAddr AddressSpace::getFuncAddr(const std::string &name) const {
-    NameEntry key(0,name,"");
-    NamesByName::const_iterator nameIt=namesByName.lower_bound(&key);
+    sortNames();
+    const NameTable &table=names;
+    std::vector<uint32_t>::const_iterator nameIt=
+        std::lower_bound(namesByName.begin(),namesByName.end(),name,[&table](uint32_t i, const std::string &n) {
+        return (table[i].func<n);
+    });
     if(nameIt==namesByName.end())
         return 0;
-    if((*nameIt)->func!=name)
+    if(names[*nameIt].func!=name)
         return 0;
-    return (*nameIt)->addr;
+    return names[*nameIt].addr;
 }
 
 // Given a code address, return where the function begins (best guess)
 VAddr AddressSpace::getFuncAddr(VAddr addr) const {
-    NamesByAddr::const_iterator nameIt=namesByAddr.lower_bound(addr);
-    if(nameIt==namesByAddr.end())
+    sortNames();
+    NameTable::const_iterator nameIt=std::upper_bound(names.begin(),names.end(),addr,[](VAddr a, const NameEntry &e) {
+        return (a<e.addr);
+    });
+    if(nameIt==names.begin())
         fail("");
-    return nameIt->addr;
+    return (nameIt-1)->addr;
 }
 
 // Given a code address, return the function size (best guess)
 size_t AddressSpace::getFuncSize(VAddr addr) const {
-    NamesByAddr::const_iterator nameIt=namesByAddr.lower_bound(addr);
-    I(nameIt!=namesByAddr.end());
-    VAddr abeg=nameIt->addr;
-    do {
-        nameIt--;
-        I(nameIt!=namesByAddr.end());
-    } while(nameIt->addr==abeg);
+    VAddr abeg=getFuncAddr(addr);
+    NameTable::const_iterator nameIt=std::upper_bound(names.begin(),names.end(),abeg,[](VAddr a, const NameEntry &e) {
+        return (a<e.addr);
+    });
+    I(nameIt!=names.end());
     VAddr aend=nameIt->addr;
     return aend-abeg;
 }
 
+bool AddressSpace::findFunc(VAddr addr, VAddr &begAddr, VAddr &endAddr) const {
+    sortNames();
+    NameTable::const_iterator nameIt=std::upper_bound(names.begin(),names.end(),addr,[](VAddr a, const NameEntry &e) {
+        return (a<e.addr);
+    });
+    endAddr=(nameIt==names.end())?~VAddr(0):nameIt->addr;
+    if(nameIt==names.begin()) {
+        begAddr=0;
+        return false;
+    }
+    begAddr=(nameIt-1)->addr;
+    return true;
+}
+
 // Print name(s) of function(s) with given entry point
 void AddressSpace::printFuncName(VAddr addr) const {
-    NamesByAddr::const_iterator it=namesByAddr.lower_bound(addr);
     bool first=true;
-    while((it!=namesByAddr.end())&&(it->addr==addr)) {
-        std::cout << (first?"":", ") << it->file << ":" << it->func;
+    for(size_t idx=lowerName(addr); (idx<names.size())&&(names[idx].addr==addr); idx++) {
+        std::cout << (first?"":", ") << *names[idx].file << ":" << names[idx].func;
         first=false;
-        it++;
     }
 }
 
 void AddressSpace::addHandler(const std::string &name, NameToFuncMap &map, EmulFunc *func) {
+    handlerGen++;
     map[name].push_back(func);
     //  map.insert(NameToFuncMap::value_type(name.c_str(),func));
 }
@@ -473,6 +587,7 @@ void AddressSpace::delHandler(const std::string &name, NameToFuncMap &map, EmulF
         curIt++;
     if(curIt==endIt)
         return;
+    handlerGen++;
     map[name].erase(curIt);
     if(!map.count(name))
         map.erase(name);
@@ -500,6 +615,7 @@ bool AddressSpace::getHandlers(const std::string &name, const NameToFuncMap &map
 }
 AddressSpace::NameToFuncMap AddressSpace::nameToCallHandler;
 AddressSpace::NameToFuncMap AddressSpace::nameToRetHandler;
+size_t AddressSpace::handlerGen=0;
 void AddressSpace::addCallHandler(const std::string &name,EmulFunc *func) {
     addHandler(name,nameToCallHandler,func);
 }
@@ -512,17 +628,63 @@ void AddressSpace::delCallHandler(const std::string &name,EmulFunc *func) {
 void AddressSpace::delRetHandler(const std::string &name,EmulFunc *func) {
     delHandler(name,nameToRetHandler,func);
 }
-bool AddressSpace::getCallHandlers(VAddr addr, HandlerSet &set) const {
+///
+// Resolve each named handler to the entry points with that name. When an
+// entry point has several names with handlers, only the first name (in name
+// order) is intercepted.
+void AddressSpace::bindHandlers(const NameToFuncMap &map, AddrToFuncTable &table) const {
+    typedef std::pair<VAddr,NameToFuncMap::const_iterator> Binding;
+    std::vector<Binding> bindings;
+    const NameTable &nameTable=names;
+    for(NameToFuncMap::const_iterator mapIt=map.begin(); mapIt!=map.end(); mapIt++) {
+        if(mapIt->first.empty()||mapIt->second.empty())
+            continue;
+        std::vector<uint32_t>::const_iterator nameIt=
+            std::lower_bound(namesByName.begin(),namesByName.end(),mapIt->first,[&nameTable](uint32_t i, const std::string &n) {
+            return (nameTable[i].func<n);
+        });
+        for(; (nameIt!=namesByName.end())&&(names[*nameIt].func==mapIt->first); nameIt++)
+            bindings.push_back(Binding(names[*nameIt].addr,mapIt));
+    }
+    // Map iterators are in name order, so this sorts by address, then name
+    std::sort(bindings.begin(),bindings.end(),[](const Binding &b1, const Binding &b2) {
+        if(b1.first!=b2.first)
+            return (b1.first<b2.first);
+        return (b1.second->first<b2.second->first);
+    });
+    table.clear();
+    for(size_t i=0; i<bindings.size(); i++) {
+        if((i>0)&&(bindings[i].first==bindings[i-1].first))
+            continue;
+        const HandlerSet &hset=bindings[i].second->second;
+        for(HandlerSet::const_iterator it=hset.begin(); it!=hset.end(); it++)
+            table.push_back(std::make_pair(bindings[i].first,*it));
+    }
+}
+bool AddressSpace::getBoundHandlers(VAddr addr, const NameToFuncMap &map, const AddrToFuncTable &table, HandlerSet &set) const {
+    sortNames();
+    if(addrToHandlerGen!=handlerGen) {
+        bindHandlers(nameToCallHandler,addrToCallHandler);
+        bindHandlers(nameToRetHandler,addrToRetHandler);
+        addrToHandlerGen=handlerGen;
+    }
+    AddrToFuncTable::const_iterator it=std::lower_bound(table.begin(),table.end(),addr,
+        [](const std::pair<VAddr,EmulFunc *> &e, VAddr a) {
+        return (e.first<a);
+    });
     bool rv=false;
-    for(NamesByAddr::iterator it=namesByAddr.lower_bound(addr); (it!=namesByAddr.end())&&(it->addr==addr); it++)
-        rv=rv||getHandlers(it->func,nameToCallHandler,set);
-    return rv||getHandlers("",nameToCallHandler,set);
+    for(; (it!=table.end())&&(it->first==addr); it++) {
+        set.push_back(it->second);
+        rv=true;
+    }
+    // Handlers registered for "" intercept every function without its own
+    return rv||getHandlers("",map,set);
+}
+bool AddressSpace::getCallHandlers(VAddr addr, HandlerSet &set) const {
+    return getBoundHandlers(addr,nameToCallHandler,addrToCallHandler,set);
 }
 bool AddressSpace::getRetHandlers(VAddr addr, HandlerSet &set) const {
-    bool rv=false;
-    for(NamesByAddr::iterator it=namesByAddr.lower_bound(addr); (it!=namesByAddr.end())&&(it->addr==addr); it++)
-        rv=rv||getHandlers(it->func,nameToRetHandler,set);
-    return rv||getHandlers("",nameToRetHandler,set);
+    return getBoundHandlers(addr,nameToRetHandler,addrToRetHandler,set);
 }
 
 VAddr AddressSpace::newSegmentAddr(size_t len) {
@@ -676,6 +838,27 @@ void AddressSpace::newSegment(VAddr addr, size_t len, bool canRead, bool canWrit
     newSeg.fileOffset=shared?offs:0;
     pageTable.map(newSeg.pageNumLb(),newSeg.pageNumUb(),canRead,canWrite,canExec,shared,fdesc,offs);
 }
+void AddressSpace::getHostSpans(VAddr addr, size_t len, bool forWrite, std::vector<struct iovec> &spans) {
+    I(forWrite?canWrite(addr,len):canRead(addr,len));
+    while(len) {
+        size_t nowLen=getPageSize()-(addr&(getPageSize()-1));
+        if(nowLen>len)
+            nowLen=len;
+        PageDesc &myPage=pageTable[getPageNum(addr)];
+        int8_t *data=forWrite?myPage.getWrData(addr):const_cast<int8_t *>(myPage.getRdData(addr));
+        // Frames carved from the same arena are often adjacent on the host
+        if((!spans.empty())&&(static_cast<int8_t *>(spans.back().iov_base)+spans.back().iov_len==data)) {
+            spans.back().iov_len+=nowLen;
+        } else {
+            struct iovec span;
+            span.iov_base=data;
+            span.iov_len=nowLen;
+            spans.push_back(span);
+        }
+        addr+=nowLen;
+        len-=nowLen;
+    }
+}
 void AddressSpace::protectSegment(VAddr addr, size_t len, bool canRead, bool canWrite, bool canExec) {
     splitSegment(addr);
     splitSegment(addr+len);
@@ -49,9 +49,21 @@ private:
         }
         return retVal;
     }
+    // Page storage for frames that are not a view of a host file mapping.
+    // Pages are carved from large host allocations and recycled, instead of
+    // being allocated one at a time.
+    typedef std::vector<MemAlignType *> DataList;
+    static DataList  freeData;
+    static int8_t   *arenaNext;
+    static int8_t   *arenaEnd;
+    static MemAlignType *newData(bool zero);
+    static void delData(MemAlignType *ptr);
+
     PAddr    basePAddr;
     bool     shared;
     bool     dirty;
+    // Is data a view of the file's host mapping (not owned by this frame)
+    bool     mapped;
     FileSys::SeekableDescription::pointer  fileDesc;
     off_t                          fileOff;
     struct FileMapKey {
@@ -72,7 +84,7 @@ private:
     // Private constructor, used by the public create(fs,offs) method
     FrameDesc(FileSys::SeekableDescription *fdesc, off_t offs);
 
-    MemAlignType data[AddrSpacPageSize/sizeof(MemAlignType)];
+    MemAlignType *data;
 #if (defined HAS_MEM_STATE)
     MemState state[AddrSpacPageSize/MemState::Granularity];
 #endif
@@ -97,6 +109,11 @@ public:
     int8_t *getData(VAddr addr) {
         return reinterpret_cast<int8_t *>(data)+(addr&AddrSpacPageOffsMask);
     }
+    // Like getData, for a caller that is about to write through the pointer
+    int8_t *getWrData(VAddr addr) {
+        dirty=true;
+        return getData(addr);
+    }
     PAddr getPAddr(VAddr addr) const {
         return basePAddr+(addr&AddrSpacPageOffsMask);
     }
@@ -204,6 +221,19 @@ private:
                 doWrCopy();
             return frame->write<T>(addr,val);
         }
+        // Host pointers to the page's data for bulk reads and writes
+        inline const int8_t *getRdData(VAddr addr) const {
+            if(!(flags&CanRead))
+                fail("PageDesc::getRdData from non-readable page\n");
+            return frame->getData(addr);
+        }
+        inline int8_t *getWrData(VAddr addr) {
+            if(!(flags&CanWrite))
+                fail("PageDesc::getWrData from non-writeable page\n");
+            if(flags&WrCopy)
+                doWrCopy();
+            return frame->getWrData(addr);
+        }
         template<class T>
         inline T fetch(VAddr addr) const {
             if(!(flags&CanExec))
@@ -409,6 +439,10 @@ public:
                 return false;
         return true;
     }
+    // Appends to spans the host memory that holds [addr,addr+len), so system
+    // calls can pass simulated buffers to host readv/writev without copying.
+    // For a write, copy-on-write is resolved up front for the whole block.
+    void getHostSpans(VAddr addr, size_t len, bool forWrite, std::vector<struct iovec> &spans);
     // Returns true iff the entire specified block is executable
     bool canExec(VAddr addr, size_t len) const {
         for(PageNum pageNum=getPageNumLb(addr); pageNum<getPageNumUb(addr+len); pageNum++)
@@ -589,36 +623,35 @@ public:
     //
 private:
     struct NameEntry {
-        VAddr       addr;
-        std::string func;
-        std::string file;
-        NameEntry(VAddr addr) : addr(addr), func(), file() {
+        VAddr              addr;
+        std::string        func;
+        // Interned, every symbol of an ELF file shares its name
+        const std::string *file;
+        NameEntry(VAddr addr, const std::string &func, const std::string *file) : addr(addr), func(func), file(file) {
         }
-        NameEntry(VAddr addr, const std::string &func, const std::string &file) : addr(addr), func(func), file(file) {
+        bool operator<(const NameEntry &other) const {
+            if(addr!=other.addr)
+                return (addr<other.addr);
+            if(func!=other.func)
+                return (func<other.func);
+            return (*file<*other.file);
+        }
+        bool operator==(const NameEntry &other) const {
+            return (addr==other.addr)&&(func==other.func)&&(file==other.file);
         }
-        struct ByAddr {
-            bool operator()(const NameEntry &e1, const NameEntry &e2) const {
-                if(e1.addr!=e2.addr)
-                    return (e1.addr>e2.addr);
-                if(e1.func!=e2.func)
-                    return (e1.func<e2.func);
-                return (e1.file<e2.file);
-            }
-        };
-        struct ByName {
-            bool operator()(const NameEntry *e1, const NameEntry *e2) const {
-                if(e1->func!=e2->func)
-                    return (e1->func<e2->func);
-                if(e1->file!=e2->file)
-                    return (e1->file<e2->file);
-                return (e1->addr<e2->addr);
-            }
-        };
     };
-    typedef std::set< NameEntry, NameEntry::ByAddr >   NamesByAddr;
-    NamesByAddr namesByAddr;
-    typedef std::set< const NameEntry *, NameEntry::ByName > NamesByName;
-    NamesByName namesByName;
+    typedef std::vector<NameEntry> NameTable;
+    // Sorted by address, then name. New names are appended and the table is
+    // sorted again only when it is next searched, so loading a symbol table
+    // costs one sort instead of one tree insertion per symbol.
+    mutable NameTable names;
+    // Indices into names, sorted by name
+    mutable std::vector<uint32_t> namesByName;
+    mutable bool namesSorted;
+    void sortNames(void) const;
+    // First entry at or above addr, names.size() if none
+    size_t lowerName(VAddr addr) const;
+    static const std::string *internFile(const std::string &file);
 public:
     // Add a new function name-address mapping
     void addFuncName(VAddr addr, const std::string &func, const std::string &file);
@@ -634,6 +667,11 @@ public:
     VAddr getFuncAddr(VAddr addr) const;
     // Given a code address, return the function size (best guess)
     size_t getFuncSize(VAddr addr) const;
+    // Given a code address, find the [begAddr,endAddr) range of the function
+    // around it (best guess); endAddr is ~VAddr(0) for the last function.
+    // Returns false, with the range below the first function, if there is
+    // no function at or below addr
+    bool findFunc(VAddr addr, VAddr &begAddr, VAddr &endAddr) const;
     // Print name(s) of function(s) with given entry point
     void printFuncName(VAddr addr) const;
     //
@@ -652,9 +690,20 @@ private:
     typedef std::map<std::string,HandlerSet> NameToFuncMap;
     static NameToFuncMap nameToCallHandler;
     static NameToFuncMap nameToRetHandler;
+    // Bumped whenever a handler is added or removed
+    static size_t handlerGen;
     static void addHandler(const std::string &name, NameToFuncMap &map, EmulFunc *func);
     static void delHandler(const std::string &name, NameToFuncMap &map, EmulFunc *func);
     static bool getHandlers(const std::string &name, const NameToFuncMap &map, HandlerSet &set);
+    // Handlers resolved to the entry points of the functions they intercept,
+    // sorted by address, so decoding does not search by name
+    typedef std::vector< std::pair<VAddr,EmulFunc *> > AddrToFuncTable;
+    mutable AddrToFuncTable addrToCallHandler;
+    mutable AddrToFuncTable addrToRetHandler;
+    // handlerGen the tables were built for, or ~0 if names changed since
+    mutable size_t addrToHandlerGen;
+    void bindHandlers(const NameToFuncMap &map, AddrToFuncTable &table) const;
+    bool getBoundHandlers(VAddr addr, const NameToFuncMap &map, const AddrToFuncTable &table, HandlerSet &set) const;
 public:
     static void addCallHandler(const std::string &name,EmulFunc *func);
     static void addRetHandler(const std::string &name,EmulFunc *func);
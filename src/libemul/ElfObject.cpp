@@ -202,6 +202,18 @@ ExecMode getExecMode(FileSys::SeekableDescription *fdesc) {
         return _getExecMode<ExecMode(ExecModeBits64|ExecModeEndianBig)>(fdesc);
 }
 
+// Host view of count bytes of the file at offs, read into buf if the file can not be mapped
+static const char *viewFile(FileSys::SeekableDescription *fdesc, std::vector<char> &buf, size_t count, off_t offs) {
+    const char *data=static_cast<const char *>(fdesc->mapPage(count,offs));
+    if(data)
+        return data;
+    buf.resize(count+1);
+    ssize_t siz=fdesc->pread(&buf[0],count,offs);
+    I(siz==(ssize_t)count);
+    buf[count]=0;
+    return &buf[0];
+}
+
 template<ExecMode mode>
 void _mapFuncNames(ThreadContext *context, FileSys::SeekableDescription *fdesc, VAddr addr, size_t len, off_t off) {
     typedef typename ElfDefs<mode>::Elf_Ehdr Elf_Ehdr;
@@ -258,17 +270,16 @@ void _mapFuncNames(ThreadContext *context, FileSys::SeekableDescription *fdesc,
         case SHT_DYNSYM: {
             I(shdrs[sec].sh_entsize==sizeof(Elf_Sym));
             // Read in the symbols
+            // Symbol tables of static binaries are too big for the stack
             size_t symnum=shdrs[sec].sh_size/sizeof(Elf_Sym);
-            Elf_Sym syms[symnum];
-            ssize_t symsSiz=fdesc->pread(syms,shdrs[sec].sh_size,shdrs[sec].sh_offset);
+            std::vector<Elf_Sym> syms(symnum);
+            ssize_t symsSiz=symnum?fdesc->pread(&syms[0],shdrs[sec].sh_size,shdrs[sec].sh_offset):0;
             I(symsSiz==(ssize_t)(sizeof(Elf_Sym)*symnum));
-            I(symsSiz==(ssize_t)(sizeof(syms)));
             for(size_t sym=0; sym<symnum; sym++)
                 cvtEndianSym<mode>(syms[sym]);
-            // Read in the symbol name strings
-            char strTab[shdrs[shdrs[sec].sh_link].sh_size];
-            ssize_t strTabSiz=fdesc->pread(strTab,shdrs[shdrs[sec].sh_link].sh_size,shdrs[shdrs[sec].sh_link].sh_offset);
-            I(strTabSiz==(ssize_t)(shdrs[shdrs[sec].sh_link].sh_size));
+            // The symbol name strings are used in place when the file can be mapped
+            std::vector<char> strBuf;
+            const char *strTab=viewFile(fdesc,strBuf,shdrs[shdrs[sec].sh_link].sh_size,shdrs[shdrs[sec].sh_link].sh_offset);
             for(size_t sym=0; sym<symnum; sym++) {
                 I(ELF32_ST_TYPE(syms[sym].st_info)==ELF64_ST_TYPE(syms[sym].st_info));
                 switch(ELF64_ST_TYPE(syms[sym].st_info)) {
@@ -281,7 +292,7 @@ void _mapFuncNames(ThreadContext *context, FileSys::SeekableDescription *fdesc,
 //                 shdrs[sec].sh_type==SHT_SYMTAB?"SYMTAB":"DYNSYM",
 //                 strTab+syms[sym].st_name,
 //                 (int)(syms[sym].st_value),(int)(syms[sym].st_size),(int)(syms[sym].st_shndx));
-                    char *symNam=strTab+syms[sym].st_name;
+                    const char *symNam=strTab+syms[sym].st_name;
                     VAddr symAddr=syms[sym].st_value+loadBias;
                     if((symAddr<addr)||(symAddr>=addr+len))
                         break;
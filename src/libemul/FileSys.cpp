@@ -23,8 +23,10 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <poll.h>
+#include <limits.h>
 #include <iostream>
 // Needed to get I()
 #include "nanassert.h"
@@ -201,6 +203,30 @@ bool Description::isNonBlock(void) const {
 flags_t Description::getFlags(void) const {
     return flags;
 }
+ssize_t Description::readv(const struct iovec *iov, int iovcnt) {
+    ssize_t rtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        ssize_t rcount=read(iov[i].iov_base,iov[i].iov_len);
+        if(rcount==-1)
+            return rtotal?rtotal:-1;
+        rtotal+=rcount;
+        if((size_t)rcount<iov[i].iov_len)
+            break;
+    }
+    return rtotal;
+}
+ssize_t Description::writev(const struct iovec *iov, int iovcnt) {
+    ssize_t wtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        ssize_t wcount=write(iov[i].iov_base,iov[i].iov_len);
+        if(wcount==-1)
+            return wtotal?wtotal:-1;
+        wtotal+=wcount;
+        if((size_t)wcount<iov[i].iov_len)
+            break;
+    }
+    return wtotal;
+}
 NullNode::NullNode()
     : Node(0x000d,0,0,S_IFCHR|S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH,(ino_t)-1) {
 }
@@ -224,6 +250,30 @@ SeekableNode::SeekableNode(dev_t dev, uid_t uid, gid_t gid, mode_t mode, off_t l
     : Node(dev,uid,gid,mode,natInode) {
     Node::setSize(len);
 }
+ssize_t SeekableNode::preadv(const struct iovec *iov, int iovcnt, off_t offs) {
+    ssize_t rtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        ssize_t rcount=pread(iov[i].iov_base,iov[i].iov_len,offs+rtotal);
+        if(rcount==-1)
+            return rtotal?rtotal:-1;
+        rtotal+=rcount;
+        if((size_t)rcount<iov[i].iov_len)
+            break;
+    }
+    return rtotal;
+}
+ssize_t SeekableNode::pwritev(const struct iovec *iov, int iovcnt, off_t offs) {
+    ssize_t wtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        ssize_t wcount=pwrite(iov[i].iov_base,iov[i].iov_len,offs+wtotal);
+        if(wcount==-1)
+            return wtotal?wtotal:-1;
+        wtotal+=wcount;
+        if((size_t)wcount<iov[i].iov_len)
+            break;
+    }
+    return wtotal;
+}
 SeekableDescription::SeekableDescription(Node *node, flags_t flags)
     : Description(node,flags), pos(0) {
 }
@@ -258,6 +308,22 @@ ssize_t SeekableDescription::pread(void *buf, size_t count, off_t offs) {
 ssize_t SeekableDescription::pwrite(const void *buf, size_t count, off_t offs) {
     return dynamic_cast<SeekableNode *>(node)->pwrite(buf,count,offs);
 }
+ssize_t SeekableDescription::readv(const struct iovec *iov, int iovcnt) {
+    ssize_t rcount=dynamic_cast<SeekableNode *>(node)->preadv(iov,iovcnt,pos);
+    if(rcount>0) {
+        pos+=rcount;
+        I(pos<=getSize());
+    }
+    return rcount;
+}
+ssize_t SeekableDescription::writev(const struct iovec *iov, int iovcnt) {
+    ssize_t wcount=dynamic_cast<SeekableNode *>(node)->pwritev(iov,iovcnt,pos);
+    if(wcount>0) {
+        pos+=wcount;
+        I(pos<=getSize());
+    }
+    return wcount;
+}
 void SeekableDescription::mmap(void *data, size_t size, off_t offs) {
     ssize_t rsize=pread(data,size,offs);
     if(rsize<0)
@@ -275,15 +341,56 @@ void SeekableDescription::msync(void *data, size_t size, off_t offs) {
     I(getSize()==endoff);
     I(nbytes==(ssize_t)wsize);
 }
+void *SeekableDescription::mapPage(size_t size, off_t offs) {
+    return dynamic_cast<SeekableNode *>(node)->mapPage(size,offs);
+}
 FileNode::FileNode(struct stat &buf)
-    : SeekableNode(buf.st_dev,buf.st_uid,buf.st_gid,buf.st_mode,buf.st_size,buf.st_ino), fd(-1) {
+    : SeekableNode(buf.st_dev,buf.st_uid,buf.st_gid,buf.st_mode,buf.st_size,buf.st_ino), fd(-1), hostMap(0), hostMapLen(0), hostMapValid(0) {
     close(fd);
 }
 FileNode::~FileNode(void) {
 //    if(close(fd)!=0)
 //      fail("FileSys::FileNode destructor could not close file %s\n",name.c_str());
+    if(hostMap)
+        munmap(hostMap,hostMapLen);
+}
+void *FileNode::mapPage(size_t count, off_t offs) {
+    if(!hostMap) {
+        if(getSize()<=0)
+            return 0;
+        fd_t mfd=open(getName()->c_str(),O_RDONLY);
+        if(mfd==-1)
+            return 0;
+        // Private mapping: stores to it are never seen by the file, sync
+        // still writes dirty frames back with pwrite
+        void *addr=::mmap(0,getSize(),PROT_READ|PROT_WRITE,MAP_PRIVATE,mfd,0);
+        if(close(mfd)!=0)
+            fail("FileNode::mapPage could not close %s\n",getName()->c_str());
+        if(addr==MAP_FAILED)
+            return 0;
+        hostMap=addr;
+        hostMapLen=getSize();
+        hostMapValid=hostMapLen;
+    }
+    // The host zero-fills the tail of the last page, but touching a page that
+    // is entirely past the end of the file would fault
+    size_t hostPageSize=sysconf(_SC_PAGESIZE);
+    size_t mapEnd=(hostMapValid+hostPageSize-1)&~(hostPageSize-1);
+    if((offs<0)||((size_t)offs+count>mapEnd)||((off_t)hostMapValid<=offs))
+        return 0;
+    return reinterpret_cast<char *>(hostMap)+offs;
 }
 void FileNode::setSize(off_t nlen) {
+    if(hostMap&&(nlen<(off_t)hostMapValid)) {
+        // Frames may still point into the part of the mapping that is about
+        // to disappear, so give those pages a private copy first
+        size_t hostPageSize=sysconf(_SC_PAGESIZE);
+        for(size_t offs=(size_t)nlen&~(hostPageSize-1); offs<hostMapValid; offs+=hostPageSize) {
+            volatile char *ptr=reinterpret_cast<volatile char *>(hostMap)+offs;
+            *ptr=*ptr;
+        }
+        hostMapValid=(nlen>0)?nlen:0;
+    }
     if(truncate(getName()->c_str(),nlen)==-1)
         fail("FileNode::setSize truncate failed\n");
     Node::setSize(nlen);
@@ -313,6 +420,69 @@ ssize_t FileNode::pwrite(const void *buf, size_t count, off_t offs) {
     errno=werror;
     return wcount;
 }
+// The file is opened once for the whole transfer, which goes to the host in
+// batches of at most IOV_MAX spans
+ssize_t FileNode::preadv(const struct iovec *iov, int iovcnt, off_t offs) {
+    fd_t rfd=open(getName()->c_str(),O_RDONLY);
+    if(rfd==-1)
+        fail("FileNode::preadv could not open %s\n",getName()->c_str());
+    ssize_t rtotal=0;
+    int     rerror=0;
+    while(iovcnt>0) {
+        int     nowcnt=(iovcnt<IOV_MAX)?iovcnt:IOV_MAX;
+        size_t  nowlen=0;
+        for(int i=0; i<nowcnt; i++)
+            nowlen+=iov[i].iov_len;
+        ssize_t rcount=::preadv(rfd,iov,nowcnt,offs+rtotal);
+        if(rcount==-1) {
+            rerror=errno;
+            if(!rtotal)
+                rtotal=-1;
+            break;
+        }
+        rtotal+=rcount;
+        if((size_t)rcount<nowlen)
+            break;
+        iov+=nowcnt;
+        iovcnt-=nowcnt;
+    }
+    if(close(rfd)!=0)
+        fail("FileNode::preadv could not close %s\n",getName()->c_str());
+    errno=rerror;
+    return rtotal;
+}
+ssize_t FileNode::pwritev(const struct iovec *iov, int iovcnt, off_t offs) {
+    fd_t wfd=open(getName()->c_str(),O_WRONLY);
+    if(wfd==-1)
+        fail("FileNode::pwritev could not open %s\n",getName()->c_str());
+    off_t   olen=getSize();
+    ssize_t wtotal=0;
+    int     werror=0;
+    while(iovcnt>0) {
+        int     nowcnt=(iovcnt<IOV_MAX)?iovcnt:IOV_MAX;
+        size_t  nowlen=0;
+        for(int i=0; i<nowcnt; i++)
+            nowlen+=iov[i].iov_len;
+        ssize_t wcount=::pwritev(wfd,iov,nowcnt,offs+wtotal);
+        if(wcount==-1) {
+            werror=errno;
+            if(!wtotal)
+                wtotal=-1;
+            break;
+        }
+        wtotal+=wcount;
+        if((size_t)wcount<nowlen)
+            break;
+        iov+=nowcnt;
+        iovcnt-=nowcnt;
+    }
+    if(close(wfd)!=0)
+        fail("FileNode::pwritev could not close %s\n",getName()->c_str());
+    if((wtotal>0)&&(offs+wtotal>olen))
+        SeekableNode::setSize(offs+wtotal);
+    errno=werror;
+    return wtotal;
+}
 FileDescription::FileDescription(FileNode *node, flags_t flags)
     : SeekableDescription(node,flags) {
 }
@@ -432,6 +602,35 @@ ssize_t StreamDescription::read(void *buf, size_t count) {
 ssize_t StreamDescription::write(const void *buf, size_t count) {
     return dynamic_cast<StreamNode *>(node)->write(buf,count);
 }
+// Like Description::readv, but also stops before a span that would block
+ssize_t StreamDescription::readv(const struct iovec *iov, int iovcnt) {
+    ssize_t rtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        if(i&&willRdBlock())
+            break;
+        ssize_t rcount=read(iov[i].iov_base,iov[i].iov_len);
+        if(rcount==-1)
+            return rtotal?rtotal:-1;
+        rtotal+=rcount;
+        if((size_t)rcount<iov[i].iov_len)
+            break;
+    }
+    return rtotal;
+}
+ssize_t StreamDescription::writev(const struct iovec *iov, int iovcnt) {
+    ssize_t wtotal=0;
+    for(int i=0; i<iovcnt; i++) {
+        if(i&&willWrBlock())
+            break;
+        ssize_t wcount=write(iov[i].iov_base,iov[i].iov_len);
+        if(wcount==-1)
+            return wtotal?wtotal:-1;
+        wtotal+=wcount;
+        if((size_t)wcount<iov[i].iov_len)
+            break;
+    }
+    return wtotal;
+}
 
 PipeNode::PipeNode(void)
     : StreamNode(0x0007,0x0000,getuid(),getgid(),S_IFIFO|S_IREAD|S_IWRITE), data(), readers(0), writers(0) {
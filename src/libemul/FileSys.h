@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <dirent.h>
 #include <deque>
 #include <string>
@@ -123,6 +124,11 @@ public:
     virtual flags_t getFlags(void) const;
     virtual ssize_t read(void *buf, size_t count) = 0;
     virtual ssize_t write(const void *buf, size_t count) = 0;
+    // Scatter/gather versions of read and write, used to move data directly
+    // between the file and simulated memory pages. By default these call
+    // read or write once per span and stop at the first short transfer.
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt);
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt);
 };
 class NullNode : public Node {
 protected:
@@ -144,6 +150,13 @@ protected:
 public:
     virtual ssize_t pread(void *buf, size_t count, off_t offs) = 0;
     virtual ssize_t pwrite(const void *buf, size_t count, off_t offs) = 0;
+    virtual ssize_t preadv(const struct iovec *iov, int iovcnt, off_t offs);
+    virtual ssize_t pwritev(const struct iovec *iov, int iovcnt, off_t offs);
+    // Returns a private, writable host mapping of count bytes of the file at
+    // offs, or 0 if the node can not provide one
+    virtual void *mapPage(size_t count, off_t offs) {
+        return 0;
+    }
 };
 class SeekableDescription : public Description {
 public:
@@ -160,18 +173,29 @@ public:
     virtual ssize_t write(const void *buf, size_t count);
     virtual ssize_t pread(void *buf, size_t count, off_t offs);
     virtual ssize_t pwrite(const void *buf, size_t count, off_t offs);
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt);
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt);
     virtual void mmap(void *data, size_t size, off_t offs);
     virtual void msync(void *data, size_t size, off_t offs);
+    virtual void *mapPage(size_t size, off_t offs);
 };
 class FileNode : public SeekableNode {
 private:
     fd_t fd;
+    // Host MAP_PRIVATE mapping of the whole file, created on first mapPage()
+    void  *hostMap;
+    size_t hostMapLen;
+    // Bytes of the mapping that are still backed by the file
+    size_t hostMapValid;
 public:
     FileNode(struct stat &buf);
     virtual ~FileNode(void);
     virtual void setSize(off_t nlen);
     virtual ssize_t pread(void *buf, size_t count, off_t offs);
     virtual ssize_t pwrite(const void *buf, size_t count, off_t offs);
+    virtual ssize_t preadv(const struct iovec *iov, int iovcnt, off_t offs);
+    virtual ssize_t pwritev(const struct iovec *iov, int iovcnt, off_t offs);
+    virtual void *mapPage(size_t count, off_t offs);
 };
 class FileDescription : public SeekableDescription {
 public:
@@ -234,6 +258,8 @@ public:
     void wrBlock(pid_t pid);
     virtual ssize_t read(void *buf, size_t count);
     virtual ssize_t write(const void *buf, size_t count);
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt);
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt);
 };
 class PipeNode : public StreamNode {
     typedef std::deque<uint8_t> Data;
@@ -48,6 +48,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 // To get getContext(pid), needed to implement LL/SC
 // (Remove this when ThreadContext stays in one place on thread switching)
 #include "libcore/OSSim.h"
+#include "libcore/StatsEpoch.h"
 
 #if (defined TM)
 #include "libTM/HTMManager.h"
@@ -669,8 +670,10 @@ enum InstCtlInfoEnum {
     CtlMpDS = 0x0020,   // Can map the delay slot after this (decode only if mapping needed)
     CtlNoDS = 0x0040,   // This is a decoding for a branch instruction without a delay slot, skip to next if there is a dependent delay slot
     CtlMore = 0x0080,   // There are more instructions in this decoding
+    CtlOrdr = 0x0100,   // Has side effects outside the thread, never emulate it ahead of timing
 
     CtlNMor = CtlNorm + CtlMore,
+    CtlNOrd = CtlNorm + CtlOrdr,
     CtlBr    = CtlBran + CtlMpDS,
     CtlBrL   = CtlBran + CtlMpDS + CtlLkly,
     CtlBrT   = CtlBran + CtlMpDS + CtlTarg,
@@ -1077,6 +1080,7 @@ public:
                 myinst->iupdate=1;
             }
             myinst->sescInst=createSescInst(myinst,origiaddr,curAddr-origiaddr,data.typ,data.ctl);
+            myinst->ordered=isOrdered(data.typ,data.ctl);
             myinst->aupdate=0;
             if(!(data.ctl&CtlMore))
                 break;
@@ -1106,6 +1110,28 @@ public:
             }
         }
     }
+    // Returns, traps, TM and LL/SC instructions run handlers or interact with
+    // other threads, so they are only emulated when the timing model gets to them
+    static bool isOrdered(InstTypInfo typ, InstCtlInfo ctl) {
+        if(ctl&CtlOrdr)
+            return true;
+        switch(typ&TypSubMask) {
+        case BrOpRet:
+        case BrOpCRet:
+        case BrOpTrap:
+        case BrOpCTrap:
+        case TypSynLd:
+        case TypSynSt:
+            return true;
+        default:
+            break;
+        }
+#if (defined TM)
+        return (typ&TypOpMask)==TypTMOp;
+#else
+        return false;
+#endif
+    }
     // Create a SESC Instruction for this static instruction
     static Instruction *createSescInst(const InstDesc *inst, VAddr iaddr, size_t deltaAddr, InstTypInfo typ, InstCtlInfo ctl) {
         Instruction *sescInst=new Instruction();
@@ -1570,6 +1596,9 @@ public:
 #if (defined TM)
                 }
 #endif
+                if(context->spinWaiting && (tmRWStatus == TMRW_NONTM || tmRWStatus == TMRW_INVALID)) {
+                    SpinWait::load(context, addr, static_cast<uint64_t>(val));
+                }
             }
 #if (defined TM)
             if(tmRWStatus == TMRW_ABORT) {
@@ -1693,8 +1722,12 @@ public:
                 fflush(stdout);
                 ThreadContext::resetTS = globalClock;
 
+                osSim->wakeUpCPUs();
                 GStats::reset();
 
+            } else if(type == 16) {
+                // Close the current stats epoch, tagged with the address operand
+                StatsEpoch::mark(addr);
             } else if(type == 18) {
 				/*
                 int procId = addr;
@@ -1922,7 +1955,7 @@ DecodeInst<mode>::OpMap::OpMap(void) {
 //     ops[OpKey(0xFC000000,0xE8000000)]<<OpData("swc2", CtlNorm , MemOpSt4>());
 //     ops[OpKey(0xFC000000,0xF8000000)]<<OpData("sdc2", CtlNorm , MemOpSt8>());
     //ops[OpKey(0xFC000000,0xCC000000)]<<OpData("pref", CtlNorm , TypNop   , ArgNo  , ArgNo  , ArgNo  , ImmNo  , emulJJ<AddrRegImm>());
-    ops[OpKey(0xFC000000,0xCC000000)]<<OpData("pref", CtlNorm , MemOpLd4, ArgRt  , ArgRs  , ArgNo  , ImmSExt, emulJJ<AddrRegImm>());
+    ops[OpKey(0xFC000000,0xCC000000)]<<OpData("pref", CtlNOrd , MemOpLd4, ArgRt  , ArgRs  , ArgNo  , ImmSExt, emulJJ<AddrRegImm>());
     ops[OpKey(0xFC00003F,0x4C00000F)]<<OpData( "prefx",CtlNorm , TypNop   , ArgNo  , ArgNo  , ArgNo  , ImmNo  , emulNop);
 //     ops[OpKey(0xFC000000,0xCC000000)]<<OpData("pref", CtlNorm , TypNop>());
 //     ops[OpKey(0xFC00003F,0x4C00000F)]<<OpData( "prefx",CtlNorm , TypNop>());
@@ -2241,6 +2274,7 @@ void handleSpinLockCall(InstDesc *inst, ThreadContext *context) {
     if(context->isInTM()) { fail("calling lock in TM"); }
     if(ThreadContext::inMain && !context->spinning) {
         funcDataInitCall(context, FUNC_PTHREAD_SPIN_LOCK, &handleSpinLockRet);
+        SpinWait::enter(context);
     }
     context->spinning = true;
 }
@@ -2248,6 +2282,7 @@ void handleSpinLockCall(InstDesc *inst, ThreadContext *context) {
 void handleSpinLockRet(InstDesc *inst, ThreadContext *context) {
     if(ThreadContext::inMain) {
         funcDataInitRet(context, FUNC_PTHREAD_SPIN_LOCK);
+        SpinWait::exit(context);
     }
 }
 
@@ -2261,12 +2296,14 @@ void handleSpinUnlockCall(InstDesc *inst, ThreadContext *context) {
 void handleBarrierCall(InstDesc *inst, ThreadContext *context) {
     if(ThreadContext::inMain) {
         funcDataInitCall(context, FUNC_PTHREAD_BARRIER, &handleBarrierRet);
+        SpinWait::enter(context);
     }
 }
 
 void handleBarrierRet(InstDesc *inst, ThreadContext *context) {
     if(ThreadContext::inMain) {
         funcDataInitRet(context, FUNC_PTHREAD_BARRIER);
+        SpinWait::exit(context);
     }
 }
 // main call/return
@@ -2316,11 +2353,13 @@ void handleTMEndFallbackRet(InstDesc *inst, ThreadContext *context) {
 void handleTMWaitCall(InstDesc *inst, ThreadContext *context) {
     if(ThreadContext::inMain) {
         funcDataInitCall(context, FUNC_TM_WAIT, &handleTMWaitRet);
+        SpinWait::enter(context);
     }
 }
 void handleTMWaitRet(InstDesc *inst, ThreadContext *context) {
     if(ThreadContext::inMain) {
         funcDataInitRet(context, FUNC_TM_WAIT);
+        SpinWait::exit(context);
     }
 }
 
@@ -207,6 +207,9 @@ public:
     RegName      regSrc2;
     uint8_t      iupdate;
     uint8_t      aupdate;
+    // Emulating this ahead of the timing model could change what the timing
+    // model or other threads observe (see ExecutionFlow run-ahead)
+    bool         ordered;
 #if (defined DEBUG)
     InstTypInfo  typ;
     VAddr        addr;
@@ -214,7 +217,7 @@ public:
     const char  *name;
 #endif
 public:
-    InstDesc(void) : sescInst(0) {
+    InstDesc(void) : sescInst(0), ordered(true) {
 #if (defined DEBUG)
 //    emul=0;
 //    regDst=RegNone;
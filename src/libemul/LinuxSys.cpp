@@ -831,6 +831,8 @@ class RealLinuxSys : public LinuxSys, public ArchDefs<mode> {
         {
         }
     };
+    const static decltype(Base::V__NR_readv) V__NR_readv = Base::V__NR_readv;
+    void sysReadV(ThreadContext *context, InstDesc *inst, int argPos);
     const static decltype(Base::V__NR_writev) V__NR_writev = Base::V__NR_writev;
     void sysWriteV(ThreadContext *context, InstDesc *inst, int argPos);
     typedef typename Base::Toff_t  Toff_t;
@@ -3633,18 +3635,17 @@ void RealLinuxSys<mode>::sysRead(ThreadContext *context, InstDesc *inst, int arg
         context->suspend();
         return;
     }
-    uint8_t * rbuf = new uint8_t[count];
-    ssize_t rcount=description->read(rbuf,count);
+    // Read straight into the simulated pages
+    std::vector<struct iovec> spans;
+    context->getWrMemSpans(buf,(size_t)count,spans);
+    ssize_t rcount=description->readv(spans.data(),spans.size());
     I(rcount>=0);
 #ifdef DEBUG_FILES
     printf("[%d] read %d wants %ld gets %ld bytes\n",context->gettid(),fd,(long)count,(long)rcount);
 #endif
-    if(rcount==-1) {
-        delete [] rbuf;
+    if(rcount==-1)
         return setSysErr(context);
-    }
-    context->writeMemFromBuf(buf,(size_t)rcount,rbuf);
-    delete [] rbuf;
+    context->wroteMemSpans(buf,(size_t)rcount);
     return setSysRet(context,Tssize_t(rcount));
 }
 template<ExecMode mode>
@@ -3692,10 +3693,9 @@ void RealLinuxSys<mode>::sysWrite(ThreadContext *context, InstDesc *inst, int ar
         context->suspend();
         return;
     }
-    uint8_t *rbuf = new uint8_t[count];
-    context->readMemToBuf(buf,(size_t)count,rbuf);
-    ssize_t wcount=description->write(rbuf,count);
-    delete [] rbuf;
+    std::vector<struct iovec> spans;
+    context->getRdMemSpans(buf,(size_t)count,spans);
+    ssize_t wcount=description->writev(spans.data(),spans.size());
     I(wcount>=0);
 #ifdef DEBUG_FILES
     printf("[%d] write %d wants %ld gets %ld bytes\n",context->gettid(),fd,(long)count,(long)wcount);
@@ -3705,6 +3705,61 @@ void RealLinuxSys<mode>::sysWrite(ThreadContext *context, InstDesc *inst, int ar
     return setSysRet(context,Tssize_t(wcount));
 }
 template<ExecMode mode>
+void RealLinuxSys<mode>::sysReadV(ThreadContext *context, InstDesc *inst, int argPos) {
+#if (defined TM)
+	assert(!context->isInTM());
+#endif
+    Tint       fd;
+    Tpointer_t vector;
+    Tint       iovcnt;
+    CallArgs(context, argPos) >> fd >> vector >> iovcnt;
+    if(iovcnt<=0)
+        return setSysErr(context,VEINVAL);
+    FileSys::OpenFiles *openFiles=context->getOpenFiles();
+    if(!openFiles->isOpen(fd))
+        return setSysErr(context,VEBADF);
+    if(!context->canRead(vector,iovcnt*Tiovec::getSize()))
+        return setSysErr(context,VEFAULT);
+    Tssize_t count=0;
+    for(Tint i=0; i<iovcnt; i++) {
+        Tiovec iov(context,vector+i*Tiovec::getSize());
+        if(!context->canWrite(iov.iov_base,iov.iov_len))
+            return setSysErr(context,VEFAULT);
+        count+=iov.iov_len;
+    }
+    if(!count)
+        return setSysRet(context,0);
+    FileSys::Description *description=openFiles->getDescription(fd);
+    if(!description->canRd())
+        return setSysErr(context,VEBADF);
+    FileSys::StreamDescription *sdescription=dynamic_cast<FileSys::StreamDescription *>(description);
+    if(sdescription&&sdescription->willRdBlock()) {
+        fail("readv would block!\n");
+    }
+    std::vector<struct iovec> spans;
+    for(Tint i=0; i<iovcnt; i++) {
+        Tiovec iov(context,vector+i*Tiovec::getSize());
+        context->getWrMemSpans(iov.iov_base,iov.iov_len,spans);
+    }
+    ssize_t rcount=description->readv(spans.data(),spans.size());
+#ifdef DEBUG_FILES
+    int e=errno;
+    printf("[%d] readv %d wants %ld gets %ld bytes\n",context->gettid(),fd,(long)count,(long)rcount);
+    errno=e;
+#endif
+    if(rcount==-1)
+        return setSysErr(context);
+    // Mark the bytes written, in the order the iovecs were filled
+    size_t left=rcount;
+    for(Tint i=0; left&&(i<iovcnt); i++) {
+        Tiovec iov(context,vector+i*Tiovec::getSize());
+        size_t nowLen=(left<iov.iov_len)?left:(size_t)iov.iov_len;
+        context->wroteMemSpans(iov.iov_base,nowLen);
+        left-=nowLen;
+    }
+    return setSysRet(context,Tssize_t(rcount));
+}
+template<ExecMode mode>
 void RealLinuxSys<mode>::sysWriteV(ThreadContext *context, InstDesc *inst, int argPos) {
     Tint       fd;
     Tpointer_t vector;
@@ -3729,19 +3784,17 @@ void RealLinuxSys<mode>::sysWriteV(ThreadContext *context, InstDesc *inst, int a
     FileSys::Description *description=openFiles->getDescription(fd);
     if(!description->canWr())
         return setSysErr(context,VEBADF);
-    uint8_t wbuf[count];
-    size_t  pos=0;
+    std::vector<struct iovec> spans;
     for(Tint i=0; i<iovcnt; i++) {
         Tiovec iov(context,vector+i*Tiovec::getSize());
         I(context->canRead(iov.iov_base,iov.iov_len));
-        context->readMemToBuf(iov.iov_base,iov.iov_len,wbuf+pos);
-        pos+=iov.iov_len;
+        context->getRdMemSpans(iov.iov_base,iov.iov_len,spans);
     }
     FileSys::StreamDescription *sdescription=dynamic_cast<FileSys::StreamDescription *>(description);
     if(sdescription&&sdescription->willWrBlock()) {
         fail("writev would block!\n");
     }
-    ssize_t wcount=description->write(wbuf,count);
+    ssize_t wcount=description->writev(spans.data(),spans.size());
 #ifdef DEBUG_FILES
     int e=errno;
     printf("[%d] writev %d wants %ld gets %ld bytes\n",context->gettid(),fd,(long)count,(long)wcount);
@@ -4836,6 +4889,9 @@ InstDesc *RealLinuxSys<mode>::sysCallExecute(ThreadContext *context, InstDesc *i
     case V__NR_write:
         sysWrite(context,inst, argPos);
         break;
+    case V__NR_readv:
+        sysReadV(context,inst, argPos);
+        break;
     case V__NR_writev:
         sysWriteV(context,inst, argPos);
         break;
@@ -5049,7 +5105,6 @@ InstDesc *RealLinuxSys<mode>::sysCallExecute(ThreadContext *context, InstDesc *i
 //  case 4142: sysCall32__newselect(inst,context); break;
 //  case 4143: sysCall32_flock(inst,context); break;
 //  case 4144: sysCall32_msync(inst,context); break;
-//  case 4145: sysCall32_readv(inst,context); break;
 //  case 4147: sysCall32_cacheflush(inst,context); break;
 //  case 4148: sysCall32_cachectl(inst,context); break;
 //  case 4149: sysCall32_sysmips(inst,context); break;
@@ -37,6 +37,13 @@ ExecutionFlow::ExecutionFlow(int32_t cId, int32_t i, GMemorySystem *gmem)
     context=0;
 
     pendingDInst = 0;
+
+    runAheadSize = 0;
+    if(SescConf->checkInt("cpucore", "emulRunAhead", cId)) {
+        SescConf->isBetween("cpucore", "emulRunAhead", 0, 4096, cId);
+        runAheadSize = SescConf->getInt("cpucore", "emulRunAhead", cId);
+    }
+    nextIAddr = 0;
 }
 
 void ExecutionFlow::exeInstFast()
@@ -60,6 +67,12 @@ void ExecutionFlow::switchIn(int32_t i)
 #endif
     I(context->getPid()==i);
 
+    // The thread may arrive with instructions run ahead on another flow
+    if(context->hasRunAhead())
+        nextIAddr=context->getRunAhead(runAheadSize)->top().inst->getAddr();
+    else
+        nextIAddr=context->getIAddr();
+
     //I(!pendingDInst);
     if( pendingDInst ) {
         pendingDInst->scrap();
@@ -93,6 +106,13 @@ DInst *ExecutionFlow::executePC()
     if(thread->checkStall()) {
         return 0;
     }
+    if(thread->hasRunAhead()) {
+        FastQueue<ThreadContext::RunAheadInst> *queue=thread->getRunAhead(runAheadSize);
+        ThreadContext::RunAheadInst ra=queue->top();
+        queue->pop();
+        nextIAddr=ra.nextIAddr;
+        return DInst::createDInst(ra.inst,ra.dAddr,fid,thread);
+    }
     InstDesc *iDesc=thread->getIDesc();
 #ifdef DEBUG
     //printf("S @0x%lx\n",iDesc->addr);
@@ -104,7 +124,59 @@ DInst *ExecutionFlow::executePC()
     ThreadStats::incNExedInsts(thread->getPid());
     VAddr vaddr=thread->getDAddr();
     thread->setDAddr(0);
-    return DInst::createDInst(iDesc->getSescInst(),vaddr,fid,thread);
+    nextIAddr=thread->getIAddr();
+    DInst *dinst=DInst::createDInst(iDesc->getSescInst(),vaddr,fid,thread);
+
+    if(runAheadSize && context==thread)
+        fillRunAhead(thread);
+
+    return dinst;
+}
+
+///
+// Emulate up to runAheadSize instructions past the one just fetched, so that
+// the emulator and the timing model each run in long batches. Anything whose
+// outcome may depend on timing stops the batch: the instruction is then only
+// emulated once fetch has drained the queue, in the same order as without
+// run-ahead. Only plain loads and stores can observe (or be observed by) other
+// threads up to runAheadSize instructions early.
+void ExecutionFlow::fillRunAhead(ThreadContext *thread)
+{
+    // HTM conflicts and spin-wait elision depend on the access order
+    if(thread->spinWaiting)
+        return;
+#if (defined TM)
+    if(thread->isInTM())
+        return;
+#endif
+
+    FastQueue<ThreadContext::RunAheadInst> *queue=thread->getRunAhead(runAheadSize);
+    while(queue->size()<runAheadSize) {
+        InstDesc *iDesc=thread->getIDesc();
+        // Handlers, trace cuts, and instructions with side effects
+        if(!iDesc||iDesc->ordered||thread->hasReadySignal())
+            break;
+#if (defined TM)
+        // Every access goes through the HTM manager, which may abort others
+        if(htmManager&&iDesc->getSescInst()->isMemory())
+            break;
+#endif
+        InstDesc *exeDesc=(*iDesc)(thread);
+        if(!exeDesc)
+            break;
+
+        ThreadStats::incNExedInsts(thread->getPid());
+        ThreadContext::RunAheadInst ra;
+        ra.inst     =exeDesc->getSescInst();
+        ra.dAddr    =thread->getDAddr();
+        ra.nextIAddr=thread->getIAddr();
+        thread->setDAddr(0);
+        queue->push(ra);
+
+        // Faults and signals redirect the thread
+        if(exeDesc!=iDesc||thread->checkStall())
+            break;
+    }
 }
 
 void ExecutionFlow::goRabbitMode(long long n2skip)
@@ -126,6 +198,13 @@ void ExecutionFlow::goRabbitMode(long long n2skip)
 
     nExec=0;
 
+    // Instructions that were emulated ahead are not timed either
+    if(context && context->hasRunAhead()) {
+        FastQueue<ThreadContext::RunAheadInst> *queue=context->getRunAhead(runAheadSize);
+        while(!queue->empty())
+            queue->pop();
+    }
+
     do {
         ev=NoEvent;
         if( n2skip > 0 )
@@ -48,15 +48,22 @@ private:
 
     DInst *pendingDInst;
 
+    // Instructions emulated ahead of fetch (cpucore:emulRunAhead), zero to
+    // emulate each instruction when it is fetched
+    size_t runAheadSize;
+    // Address after the last instruction handed to fetch
+    VAddr  nextIAddr;
+
     void propagateDepsIfNeeded() { }
 
     void exeInstFast();
+    void fillRunAhead(ThreadContext *thread);
 
 protected:
 public:
     InstID getNextID() const {
         I(context);
-        return context->getIAddr();
+        return nextIAddr;
     }
 
     void addEvent(EventType e, CallbackBase *cb, int32_t addr) {
@@ -76,6 +83,10 @@ public:
         return context->getPid();
     }
     DInst *executePC();
+    // True while the thread is stalled and executePC returns nothing
+    bool isStalled() const {
+        return context && context->checkStall();
+    }
 
     void goRabbitMode(long long n2skip=0);
     void dump(const char *str) const;
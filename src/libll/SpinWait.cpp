@@ -0,0 +1,194 @@
+#include "SescConf.h"
+#include "ThreadContext.h"
+#include "ThreadStats.h"
+#include "SpinWait.h"
+
+using namespace std;
+
+bool     SpinWait::enabled          = false;
+VAddr    SpinWait::lineMask         = ~static_cast<VAddr>(63);
+uint32_t SpinWait::detectThreshold  = 4;
+uint32_t SpinWait::maxParkCycles    = 10000;
+uint32_t SpinWait::wakeupLatency    = 100;
+std::vector<SpinWait::SpinState>        SpinWait::states;
+HASH_MAP<VAddr, std::vector<Pid_t> >    SpinWait::watchers;
+size_t   SpinWait::nParked          = 0;
+
+GStatsCntr *SpinWait::nParks        = NULL;
+GStatsCntr *SpinWait::nWakes        = NULL;
+GStatsCntr *SpinWait::nTimeouts     = NULL;
+GStatsCntr *SpinWait::parkedCycles  = NULL;
+GStatsCntr *SpinWait::elidedIters   = NULL;
+GStatsCntr *SpinWait::elidedInsts   = NULL;
+GStatsCntr *SpinWait::coherenceMsgs = NULL;
+
+///
+// Read the spinElision section, if there is one
+void SpinWait::boot() {
+    if(!SescConf->checkCharPtr("", "spinElision")) {
+        return;
+    }
+    const char *section = SescConf->getCharPtr("", "spinElision");
+
+    if(SescConf->checkInt(section, "lineSize")) {
+        int32_t lineSize = SescConf->getInt(section, "lineSize");
+        SescConf->isPower2(section, "lineSize");
+        lineMask = ~static_cast<VAddr>(lineSize - 1);
+    }
+    if(SescConf->checkInt(section, "detectThreshold")) {
+        detectThreshold = SescConf->getInt(section, "detectThreshold");
+        SescConf->isGT(section, "detectThreshold", 1);
+    }
+    if(SescConf->checkInt(section, "maxParkCycles")) {
+        maxParkCycles = SescConf->getInt(section, "maxParkCycles");
+        SescConf->isGT(section, "maxParkCycles", 0);
+    }
+    if(SescConf->checkInt(section, "wakeupLatency")) {
+        wakeupLatency = SescConf->getInt(section, "wakeupLatency");
+        SescConf->isGT(section, "wakeupLatency", 0);
+    }
+
+    nParks          = new GStatsCntr("SpinWait:nParks");
+    nWakes          = new GStatsCntr("SpinWait:nWakes");
+    nTimeouts       = new GStatsCntr("SpinWait:nTimeouts");
+    parkedCycles    = new GStatsCntr("SpinWait:parkedCycles");
+    elidedIters     = new GStatsCntr("SpinWait:elidedIters");
+    elidedInsts     = new GStatsCntr("SpinWait:elidedInsts");
+    coherenceMsgs   = new GStatsCntr("SpinWait:coherenceMsgs");
+
+    enabled = true;
+    MSG("Spin-wait elision: threshold %u, max park %u cycles",
+            detectThreshold, maxParkCycles);
+}
+
+SpinWait::SpinState& SpinWait::getState(Pid_t pid) {
+    if(static_cast<size_t>(pid) >= states.size()) {
+        states.resize(pid + 1);
+    }
+    return states[pid];
+}
+
+void SpinWait::enter(ThreadContext* context) {
+    if(!enabled || context->spinWaiting) {
+        return;
+    }
+    context->spinWaiting = true;
+
+    SpinState& state = getState(context->getPid());
+    state.caddr     = 0;
+    state.repeats   = 0;
+}
+
+void SpinWait::exit(ThreadContext* context) {
+    if(!enabled) {
+        return;
+    }
+    context->spinWaiting = false;
+
+    SpinState& state = getState(context->getPid());
+    if(state.parked) {
+        unpark(state);
+        nTimeouts->inc();
+    }
+}
+
+///
+// Track the loads of a spinning thread, and park it once it has seen the same
+// value from the same line detectThreshold times in a row.
+void SpinWait::load(ThreadContext* context, VAddr addr, uint64_t val) {
+    Pid_t pid = context->getPid();
+    SpinState& state = getState(pid);
+
+    if(state.parked) {
+        // Still registered, so it was the park timeout that let us run again
+        unpark(state);
+        nTimeouts->inc();
+    }
+
+    Time_t now      = globalClock;
+    size_t nExed    = ThreadStats::getThread(pid).getNExedInsts();
+    VAddr caddr     = addr & lineMask;
+
+    if(caddr == state.caddr && val == state.val) {
+        state.repeats++;
+        state.period        = now - state.lastLoadAt;
+        state.instsPerIter  = nExed - state.lastNExed;
+    } else {
+        state.caddr     = caddr;
+        state.val       = val;
+        state.repeats   = 1;
+    }
+    state.lastLoadAt    = now;
+    state.lastNExed     = nExed;
+
+    if(state.repeats >= detectThreshold && state.period > 0) {
+        park(context, state);
+    }
+}
+
+void SpinWait::park(ThreadContext* context, SpinState& state) {
+    state.parked    = true;
+    state.parkedAt  = globalClock;
+    state.repeats   = 0;
+    watchers[state.caddr].push_back(context->getPid());
+    nParked++;
+
+    context->startStalling(maxParkCycles);
+    nParks->inc();
+}
+
+///
+// Charge the spin iterations that a parked thread did not execute, and mark it
+// as no longer parked.
+void SpinWait::charge(SpinState& state) {
+    Time_t parked = globalClock - state.parkedAt;
+    Time_t iters  = parked / state.period;
+
+    parkedCycles->add(parked);
+    elidedIters->add(iters);
+    elidedInsts->add(iters * state.instsPerIter);
+
+    state.parked = false;
+    nParked--;
+}
+
+///
+// Remove a thread that was not woken by a write from the watch list.
+void SpinWait::unpark(SpinState& state) {
+    charge(state);
+
+    HASH_MAP<VAddr, std::vector<Pid_t> >::iterator it = watchers.find(state.caddr);
+    if(it != watchers.end()) {
+        std::vector<Pid_t>& pids = it->second;
+        for(size_t i = 0; i < pids.size(); i++) {
+            if(&getState(pids[i]) == &state) {
+                pids.erase(pids.begin() + i);
+                break;
+            }
+        }
+        if(pids.empty()) {
+            watchers.erase(it);
+        }
+    }
+}
+
+///
+// A write to caddr invalidates it in every waiter's cache. Each waiter takes
+// the invalidation and a miss to re-fetch the line, then resumes spinning.
+void SpinWait::wake(VAddr caddr) {
+    HASH_MAP<VAddr, std::vector<Pid_t> >::iterator it = watchers.find(caddr);
+    if(it == watchers.end()) {
+        return;
+    }
+    std::vector<Pid_t> pids;
+    pids.swap(it->second);
+    watchers.erase(it);
+
+    for(size_t i = 0; i < pids.size(); i++) {
+        charge(getState(pids[i]));
+        coherenceMsgs->add(2);
+        nWakes->inc();
+
+        ThreadContext::getContext(pids[i])->startStalling(wakeupLatency);
+    }
+}
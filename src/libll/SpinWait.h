@@ -0,0 +1,92 @@
+#ifndef SPIN_WAIT_H
+#define SPIN_WAIT_H
+
+#include <vector>
+#include "estl.h"
+#include "Snippets.h"
+#include "GStats.h"
+#include "libemul/Addressing.h"
+
+// Forward decls to avoid circular includes
+class ThreadContext;
+
+// Spin-wait elision. A thread inside pthread_spin_lock, pthread_barrier_wait
+// or tm_wait that keeps loading the same unchanged value from a cache line is
+// parked (stalled) until someone writes that line, instead of being emulated
+// and timed one spin iteration at a time. The iterations and coherence
+// traffic that were skipped are estimated from the loop period seen while
+// detecting the spin, and are reported as SpinWait:* statistics.
+//
+// Enabled by pointing the top-level "spinElision" key at a config section.
+class SpinWait {
+public:
+    static void boot();
+    static bool isEnabled() {
+        return enabled;
+    }
+    // Called when a thread enters and leaves one of the spin-wait routines
+    static void enter(ThreadContext* context);
+    static void exit(ThreadContext* context);
+    // Called on every non-transactional load of a thread in a spin-wait routine
+    static void load(ThreadContext* context, VAddr addr, uint64_t val);
+    // Called on every write to simulated memory
+    static void write(VAddr addr) {
+        if(nParked > 0) {
+            wake(addr & lineMask);
+        }
+    }
+    // Called when a block of simulated memory is written at once
+    static void write(VAddr addr, size_t len) {
+        if(nParked > 0) {
+            for(VAddr caddr = addr & lineMask; caddr < addr + len; caddr += ~lineMask + 1)
+                wake(caddr);
+        }
+    }
+private:
+    struct SpinState {
+        SpinState(): caddr(0), val(0), repeats(0), lastLoadAt(0), lastNExed(0),
+            period(0), instsPerIter(0), parked(false), parkedAt(0) {}
+        // Line and value of the last load in the spin routine
+        VAddr       caddr;
+        uint64_t    val;
+        // Number of consecutive loads that returned the same value
+        uint32_t    repeats;
+        Time_t      lastLoadAt;
+        size_t      lastNExed;
+        // Cycles and instructions per spin iteration
+        Time_t      period;
+        size_t      instsPerIter;
+        bool        parked;
+        Time_t      parkedAt;
+    };
+    static SpinState& getState(Pid_t pid);
+    static void park(ThreadContext* context, SpinState& state);
+    static void charge(SpinState& state);
+    static void unpark(SpinState& state);
+    static void wake(VAddr caddr);
+
+    static bool     enabled;
+    static VAddr    lineMask;
+    // Number of identical loads before a thread is parked
+    static uint32_t detectThreshold;
+    // A parked thread resumes spinning after this many cycles even if the
+    // line was never written
+    static uint32_t maxParkCycles;
+    // Cycles between the waking write and the parked thread resuming
+    static uint32_t wakeupLatency;
+
+    static std::vector<SpinState> states;
+    // Parked pids, keyed by the cache line they are watching
+    static HASH_MAP<VAddr, std::vector<Pid_t> > watchers;
+    static size_t   nParked;
+
+    static GStatsCntr *nParks;
+    static GStatsCntr *nWakes;
+    static GStatsCntr *nTimeouts;
+    static GStatsCntr *parkedCycles;
+    static GStatsCntr *elidedIters;
+    static GStatsCntr *elidedInsts;
+    static GStatsCntr *coherenceMsgs;
+};
+
+#endif
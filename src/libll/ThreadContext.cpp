@@ -23,6 +23,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "libemul/FileSys.h"
 #include "libcore/ProcessId.h"
 #include "libcore/DInst.h"
+#include "libcore/StatsEpoch.h"
 
 ThreadContext::ContextVector ThreadContext::pid2context;
 bool ThreadContext::ff;
@@ -46,6 +47,8 @@ void InstContext::clear() {
 
 void ThreadContext::initialize() {
     spinning    = false;
+    spinWaiting = false;
+    runAhead    = 0;
 
 #if (defined TM)
     tmAbortArg  = 0;
@@ -124,6 +127,9 @@ TMBCStatus ThreadContext::commitTransaction(InstDesc* inst) {
             delete oldTMContext;
             tmDepth--;
 
+            if(!isInTM())
+                StatsEpoch::txnCommitted();
+
             break;
         }
         default:
@@ -363,6 +369,7 @@ ThreadContext::ThreadContext(ThreadContext &parent,
 
 ThreadContext::~ThreadContext(void) {
     I(!nDInsts);
+    delete runAhead;
     while(!maskedSig.empty()) {
         delete maskedSig.back();
         maskedSig.pop_back();
@@ -6,12 +6,14 @@
 #include <vector>
 #include <set>
 #include "Snippets.h"
+#include "FastQueue.h"
 #include "libemul/AddressSpace.h"
 #include "libemul/SignalHandling.h"
 #include "libemul/FileSys.h"
 #include "libemul/InstDesc.h"
 #include "libemul/LinuxSys.h"
 #include "ThreadStats.h"
+#include "SpinWait.h"
 
 #if (defined TM)
 #include "libTM/HTMManager.h"
@@ -213,6 +215,27 @@ public:
     }
     // END Thread stalling methods
 
+    // BEGIN Run-ahead emulation
+    // Instructions already emulated but not yet handed to the timing model.
+    // Kept here rather than in ExecutionFlow so they survive a migration.
+    struct RunAheadInst {
+        const Instruction *inst;
+        VAddr dAddr;
+        VAddr nextIAddr;
+    };
+private:
+    FastQueue<RunAheadInst> *runAhead;
+public:
+    FastQueue<RunAheadInst> *getRunAhead(size_t size) {
+        if(!runAhead)
+            runAhead = new FastQueue<RunAheadInst>(size);
+        return runAhead;
+    }
+    bool hasRunAhead() const {
+        return runAhead && !runAhead->empty();
+    }
+    // END Run-ahead emulation
+
     static inline int32_t getPidUb(void) {
         return pid2context.size();
     }
@@ -376,6 +399,19 @@ public:
     void    readMemToBuf(VAddr addr, size_t len, void *buf);
 //  ssize_t readMemToFile(VAddr addr, size_t len, int32_t fd, bool natFile);
     ssize_t readMemString(VAddr stringVAddr, size_t maxSize, char *dstStr);
+    // Host spans of simulated memory for zero-copy system call I/O. After the
+    // host fills write spans, wroteMemSpans must be told how much it wrote.
+    void    getRdMemSpans(VAddr addr, size_t len, std::vector<struct iovec> &spans) {
+        I(canRead(addr,len));
+        addressSpace->getHostSpans(addr,len,false,spans);
+    }
+    void    getWrMemSpans(VAddr addr, size_t len, std::vector<struct iovec> &spans) {
+        I(canWrite(addr,len));
+        addressSpace->getHostSpans(addr,len,true,spans);
+    }
+    void    wroteMemSpans(VAddr addr, size_t len) {
+        SpinWait::write(addr,len);
+    }
     template<class T>
     inline void readMemTM(VAddr addr, T oval, T* p_val) {
         if(tmContext == NULL) {
@@ -435,6 +471,7 @@ public:
             fail("%d writing to non-writeable page\n", pid);
         }
         addressSpace->write<T>(addr,val);
+        SpinWait::write(addr);
     }
 #if (defined DEBUG_BENCH)
     VAddr readMemWord(VAddr addr);
@@ -629,6 +666,8 @@ public:
     // Event tracing
     static bool inMain;
     bool      spinning;
+    // Inside a spin-wait routine that SpinWait may elide
+    bool      spinWaiting;
 };
 
 #endif // THREADCONTEXT_H
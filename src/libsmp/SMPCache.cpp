@@ -381,6 +381,11 @@ void SMPCache::specialOp(MemRequest *mreq)
 }
 
 void SMPCache::invalidate(PAddr addr, ushort size, MemObj *oc)
+{
+    invalidate(addr, size, oc, false);
+}
+
+void SMPCache::invalidate(PAddr addr, ushort size, MemObj *oc, bool writeBack)
 {
     Line *l = cache->findLine(addr);
 
@@ -389,7 +394,7 @@ void SMPCache::invalidate(PAddr addr, ushort size, MemObj *oc)
     pendInvTable[addr].outsResps = getNumCachesInUpperLevels();
     pendInvTable[addr].cb = doInvalidateCB::create(oc, addr, size);
     pendInvTable[addr].invalidate = true;
-    //  pendInvTable[addr].writeback = true;
+    pendInvTable[addr].writeback = writeBack;
 
     if (l)
         protocol->preInvalidate(l);
@@ -660,6 +665,18 @@ void SMPCache::writeLine(PAddr addr) {
     I(l);
 }
 
+bool SMPCache::canBeInvalidated(PAddr addr)
+{
+    if(pendInvTable.find(addr) != pendInvTable.end())
+        return false;
+
+    if(outsReq->hasEntry(addr))
+        return false;
+
+    Line *l = cache->findLine(addr);
+    return (l == 0 || !l->isLocked());
+}
+
 void SMPCache::invalidateLine(PAddr addr, CallbackBase *cb, bool writeBack)
 {
     Line *l = cache->findLine(addr);
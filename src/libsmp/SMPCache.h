@@ -171,6 +171,7 @@ public:
     void returnAccess(MemRequest *mreq);
 
     void invalidate(PAddr addr, ushort size, MemObj *oc);
+    void invalidate(PAddr addr, ushort size, MemObj *oc, bool writeBack);
     void doInvalidate(PAddr addr, ushort size);
     void realInvalidate(PAddr addr, ushort size, bool writeBack);
 
@@ -195,6 +196,10 @@ public:
     void writeLine(PAddr addr);
     void invalidateLine(PAddr addr, CallbackBase *cb, bool writeBack = false);
     Line *allocateLine(PAddr addr, CallbackBase *cb, bool canDestroyCB = true);
+
+    // True if a lower level can invalidate addr now: the line is neither
+    // pending nor in a transient state
+    bool canBeInvalidated(PAddr addr);
     void doAllocateLine(PAddr addr, PAddr rpl_addr, CallbackBase *cb);
 
     typedef CallbackMember3<SMPCache, PAddr, PAddr, CallbackBase *,
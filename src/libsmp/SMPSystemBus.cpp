@@ -24,8 +24,20 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "SMPCache.h"
 #include "SMPDebug.h"
 
+SMPSystemBus *SnoopFilterState::replacing = 0;
+
+bool SnoopFilterState::isLocked() const
+{
+    return replacing && isValid() && holders && !replacing->canBackInvalidate(this);
+}
+
 SMPSystemBus::SMPSystemBus(SMemorySystem *dms, const char *section, const char *name)
     : MemObj(section, name)
+    , snoopFilter(0)
+    , nSnoops("%s:nSnoops", name)
+    , nFilteredSnoops("%s:nFilteredSnoops", name)
+    , nFilterInvalidations("%s:nFilterInvalidations", name)
+    , nFilterRetries("%s:nFilterRetries", name)
 {
     MemObj *ll = NULL;
 
@@ -53,11 +65,18 @@ SMPSystemBus::SMPSystemBus(SMemorySystem *dms, const char *section, const char *
                                  MemPower,
                                  EnergyMgr::get(section,"BusEnergy",0));
 #endif
+
+    // bsize of the filter must be the line size of the caches above
+    if(SescConf->checkCharPtr(section, "snoopFilter")) {
+        const char *filterSection = SescConf->getCharPtr(section, "snoopFilter");
+        snoopFilter = SnoopFilter::create(filterSection, "", "%s_SF", name);
+    }
 }
 
 SMPSystemBus::~SMPSystemBus()
 {
-    // do nothing
+    if(snoopFilter)
+        snoopFilter->destroy();
 }
 
 Time_t SMPSystemBus::getNextFreeCycle() const
@@ -155,10 +174,17 @@ void SMPSystemBus::doRead(MemRequest *mreq)
 
     if(pendReqsTable.find(mreq) == pendReqsTable.end()) {
 
-        unsigned numSnoops = getNumSnoopCaches(sreq);
+        uint64_t targets = 0;
+        unsigned numSnoops = 0;
+        if(!getSnoopTargets(sreq, false, targets, numSnoops)) {
+            // no filter entry can be replaced yet
+            nFilterRetries.inc();
+            doReadCB::schedule(1, this, mreq);
+            return;
+        }
 
         // operation is starting now, add it to the pending requests buffer
-        pendReqsTable[mreq] = getNumSnoopCaches(sreq);
+        pendReqsTable[mreq] = numSnoops;
 
         if(!numSnoops) {
             // nothing to snoop on this chip
@@ -169,11 +195,7 @@ void SMPSystemBus::doRead(MemRequest *mreq)
         }
 
         // distribute requests to other caches, wait for responses
-        for(uint32_t i = 0; i < upperLevel.size(); i++) {
-            if(upperLevel[i] != static_cast<SMPMemRequest *>(mreq)->getRequestor()) {
-                upperLevel[i]->returnAccess(mreq);
-            }
-        }
+        sendSnoops(sreq, targets);
     }
     else {
         // operation has already been sent to other caches, receive responses
@@ -192,6 +214,93 @@ void SMPSystemBus::doRead(MemRequest *mreq)
     }
 }
 
+// Number of caches that must see the snoop for sreq. With a filter, targets
+// gets their bits and the requestor's entry is updated: a read adds it to the
+// holders and an exclusive request leaves it as the only one. Returns false,
+// changing nothing, if the line has no entry and none can be replaced now.
+bool SMPSystemBus::getSnoopTargets(SMPMemRequest *sreq, bool exclusive, uint64_t &targets,
+                                   unsigned &numSnoops)
+{
+    unsigned nOthers = getNumSnoopCaches(sreq);
+    if(!snoopFilter) {
+        nSnoops.add(nOthers);
+        numSnoops = nOthers;
+        return true;
+    }
+
+    if(upperLevel.size() > MaxFilterCaches)
+        fail("[%s] snoop filter supports up to %d caches\n", getSymbolicName(), MaxFilterCaches);
+
+    PAddr addr = sreq->getPAddr();
+    FilterLine *l = snoopFilter->findLine(addr);
+    if(l == 0) {
+        SnoopFilterState::replacing = this;
+        l = snoopFilter->findLine2Replace(addr);
+        SnoopFilterState::replacing = 0;
+        if(l == 0)
+            return false;
+
+        if(l->isValid() && l->holders) {
+            // The filter is inclusive: the replaced line leaves the caches too
+            PAddr rplAddr = snoopFilter->calcAddr4Tag(l->getTag());
+            for(uint32_t i = 0; i < upperLevel.size(); i++) {
+                if(l->holders & (1ULL << i))
+                    static_cast<SMPCache *>(upperLevel[i])->invalidate(rplAddr,
+                            snoopFilter->getLineSize(), this, true);
+            }
+            nFilterInvalidations.inc();
+        }
+        l->setTag(snoopFilter->calcTag(addr));
+        l->holders = 0;
+    }
+
+    uint64_t self = getCacheBit(sreq->getRequestor());
+    targets = l->holders & ~self;
+    if(exclusive)
+        l->holders = self;
+    else
+        l->holders |= self;
+
+    numSnoops = 0;
+    for(uint32_t i = 0; i < upperLevel.size(); i++) {
+        if(targets & (1ULL << i))
+            numSnoops++;
+    }
+    nSnoops.add(numSnoops);
+    nFilteredSnoops.add(nOthers - numSnoops);
+    return true;
+}
+
+// The caches above the bus are SMPCaches
+bool SMPSystemBus::canBackInvalidate(const SnoopFilterState *s) const
+{
+    PAddr addr = snoopFilter->calcAddr4Tag(s->getTag());
+    for(uint32_t i = 0; i < upperLevel.size(); i++) {
+        if((s->holders & (1ULL << i))
+                && !static_cast<SMPCache *>(upperLevel[i])->canBeInvalidated(addr))
+            return false;
+    }
+    return true;
+}
+
+void SMPSystemBus::sendSnoops(SMPMemRequest *sreq, uint64_t targets)
+{
+    for(uint32_t i = 0; i < upperLevel.size(); i++) {
+        if(snoopFilter ? (targets & (1ULL << i)) != 0 : upperLevel[i] != sreq->getRequestor())
+            upperLevel[i]->returnAccess(sreq);
+    }
+}
+
+uint64_t SMPSystemBus::getCacheBit(MemObj *cache) const
+{
+    for(uint32_t i = 0; i < upperLevel.size(); i++) {
+        if(upperLevel[i] == cache)
+            return 1ULL << i;
+    }
+    I(0);
+    return 0;
+}
+
 void SMPSystemBus::finalizeRead(MemRequest *mreq)
 {
     finalizeAccess(mreq);
@@ -209,10 +318,17 @@ void SMPSystemBus::doWrite(MemRequest *mreq)
 
     if(pendReqsTable.find(mreq) == pendReqsTable.end()) {
 
-        unsigned numSnoops = getNumSnoopCaches(sreq);
+        uint64_t targets = 0;
+        unsigned numSnoops = 0;
+        if(!getSnoopTargets(sreq, true, targets, numSnoops)) {
+            // no filter entry can be replaced yet
+            nFilterRetries.inc();
+            doWriteCB::schedule(1, this, mreq);
+            return;
+        }
 
         // operation is starting now, add it to the pending requests buffer
-        pendReqsTable[mreq] = getNumSnoopCaches(sreq);
+        pendReqsTable[mreq] = numSnoops;
 
         if(!numSnoops) {
             // nothing to snoop on this chip
@@ -223,11 +339,7 @@ void SMPSystemBus::doWrite(MemRequest *mreq)
         }
 
         // distribute requests to other caches, wait for responses
-        for(uint32_t i = 0; i < upperLevel.size(); i++) {
-            if(upperLevel[i] != static_cast<SMPMemRequest *>(mreq)->getRequestor()) {
-                upperLevel[i]->returnAccess(mreq);
-            }
-        }
+        sendSnoops(sreq, targets);
     }
     else {
         // operation has already been sent to other caches, receive responses
@@ -280,7 +392,9 @@ void SMPSystemBus::invalidate(PAddr addr, ushort size, MemObj *oc)
 
 void SMPSystemBus::doInvalidate(PAddr addr, ushort size)
 {
-    I(0);
+    // Only the snoop filter invalidates lines on its own, and nothing waits
+    // for those to complete
+    I(snoopFilter);
 }
 
 void SMPSystemBus::returnAccess(MemRequest *mreq)
@@ -25,10 +25,50 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "SMemorySystem.h"
 #include "libcore/MemObj.h"
 #include "Port.h"
+#include "CacheCore.h"
+#include "GStats.h"
 #include "estl.h"
 
+class SMPSystemBus;
+
+// Snoop filter entry: the caches above the bus that may hold the line, one
+// bit per upper level
+class SnoopFilterState : public StateGeneric<PAddr> {
+public:
+    uint64_t holders;
+
+    // Set while a bus picks the entry to replace. Entries whose line is
+    // pending or transient in a holder count as locked, so they are skipped
+    static SMPSystemBus *replacing;
+    bool isLocked() const;
+};
+
 class SMPSystemBus : public MemObj {
 private:
+    friend class SnoopFilterState;
+
+    typedef CacheGeneric<SnoopFilterState, PAddr, false> SnoopFilter;
+    typedef CacheGeneric<SnoopFilterState, PAddr, false>::CacheLine FilterLine;
+    enum { MaxFilterCaches = 64 };
+
+    // Optional inclusive filter of the lines held above the bus. Misses are
+    // snooped only by the caches it lists; when an entry is replaced, the
+    // caches it lists are invalidated (dirty lines written back) so that
+    // every held line stays listed. Clean evictions are silent, so holders
+    // are a superset. A miss that finds every entry of its set locked is
+    // retried on the next cycle.
+    SnoopFilter *snoopFilter;
+
+    GStatsCntr nSnoops;
+    GStatsCntr nFilteredSnoops;
+    GStatsCntr nFilterInvalidations;
+    GStatsCntr nFilterRetries;
+
+    uint64_t getCacheBit(MemObj *cache) const;
+    bool canBackInvalidate(const SnoopFilterState *s) const;
+    bool getSnoopTargets(SMPMemRequest *sreq, bool exclusive, uint64_t &targets,
+                         unsigned &numSnoops);
+    void sendSnoops(SMPMemRequest *sreq, uint64_t targets);
 
 protected:
     PortGeneric *busPort;
@@ -0,0 +1,82 @@
+#include <stdlib.h>
+
+#include "AsyncFileWriter.h"
+
+AsyncFileWriter::AsyncFileWriter(const char *fname, size_t bsize)
+    : bufSize(bsize)
+    , done(false)
+{
+    fd = fopen(fname, "wb");
+    if(fd == 0) {
+        fprintf(stderr, "AsyncFileWriter: could not open file [%s]\n", fname);
+        exit(-3);
+    }
+    curBuf.reserve(bufSize);
+
+    writer = std::thread(&AsyncFileWriter::writerLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    close();
+}
+
+void AsyncFileWriter::swapBuffer()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    fullBufs.push_back(Buffer());
+    fullBufs.back().swap(curBuf);
+    if(!freeBufs.empty()) {
+        curBuf.swap(freeBufs.back());
+        freeBufs.pop_back();
+    }
+    lock.unlock();
+    cv.notify_one();
+
+    curBuf.clear();
+    curBuf.reserve(bufSize);
+}
+
+void AsyncFileWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true) {
+        cv.wait(lock, [this] { return done || !fullBufs.empty(); });
+        if(fullBufs.empty()) {
+            // done and drained
+            break;
+        }
+
+        Buffer buf;
+        buf.swap(fullBufs.front());
+        fullBufs.pop_front();
+
+        lock.unlock();
+        fwrite(buf.data(), 1, buf.size(), fd);
+        buf.clear();
+        lock.lock();
+
+        freeBufs.push_back(Buffer());
+        freeBufs.back().swap(buf);
+    }
+}
+
+void AsyncFileWriter::close()
+{
+    if(fd == 0) {
+        return;
+    }
+
+    if(!curBuf.empty()) {
+        swapBuffer();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+    }
+    cv.notify_one();
+    writer.join();
+
+    fclose(fd);
+    fd = 0;
+}
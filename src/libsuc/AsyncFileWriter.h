@@ -0,0 +1,52 @@
+#ifndef ASYNCFILEWRITER_H
+#define ASYNCFILEWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+///
+// Buffered binary writer that moves file I/O off the simulation thread.
+// write() only copies into the current buffer; full buffers are handed to a
+// background thread that writes them out and returns them for reuse.
+class AsyncFileWriter {
+public:
+    AsyncFileWriter(const char *fname, size_t bufSize = 1 << 20);
+    ~AsyncFileWriter();
+
+    void write(const void *data, size_t len) {
+        if(curBuf.size() + len > bufSize) {
+            swapBuffer();
+        }
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        curBuf.insert(curBuf.end(), p, p + len);
+    }
+    // Write out everything buffered so far and stop the writer thread
+    void close();
+    bool isOpen() const { return fd != 0; }
+
+private:
+    typedef std::vector<uint8_t> Buffer;
+
+    void swapBuffer();
+    void writerLoop();
+
+    FILE                    *fd;
+    size_t                  bufSize;
+    Buffer                  curBuf;
+
+    // Shared with the writer thread, protected by mtx
+    std::mutex              mtx;
+    std::condition_variable cv;
+    std::deque<Buffer>      fullBufs;
+    std::vector<Buffer>     freeBufs;
+    bool                    done;
+
+    std::thread             writer;
+};
+
+#endif // ASYNCFILEWRITER_H
@@ -29,9 +29,6 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "EnergyMgr.h"
 #include "ReportGen.h"
-#ifdef SESC_THERM
-#include "ReportTherm.h"
-#endif
 
 GStatsEnergy::EProcStoreType  GStatsEnergy::eProcStore;
 GStatsEnergy::EGroupStoreType GStatsEnergy::eGroupStore;
@@ -41,19 +38,11 @@ double GStatsEnergyNull::getDouble() const
     return 0;
 }
 
-void GStatsEnergyNull::inc()
-{
-}
-
-void GStatsEnergyNull::add(int32_t v)
-{
-}
-
 GStatsEnergy::GStatsEnergy(const char *field, const char *blk
                            ,int32_t procId, PowerGroup grp
-                           ,double energy)
-    :StepEnergy(energy)
-    ,steps(0)
+                           ,double energy, GStatsEnergyCGBase *b)
+    :GStatsEnergyBase(b)
+    ,StepEnergy(energy)
     ,gid(grp)
 {
     if( eProcStore.size() <= static_cast<size_t>(procId) ) {
@@ -73,39 +62,22 @@ GStatsEnergy::GStatsEnergy(const char *field, const char *blk
 
 
 #ifdef SESC_THERM
-void GStatsEnergy::setupDump(int32_t procId)
+void GStatsEnergy::setupDump(int32_t procId, std::vector<const char *> &names)
 {
     I((uint32_t)procId < eProcStore.size());
 
     for (size_t i = 0; i < eProcStore[procId].size(); i++) {
-        GStatsEnergy *e = eProcStore[procId][i];
-
-        ReportTherm::field("%s\t", e->name);
-    }
-    ReportTherm::field("\n");
-#if 0
-    for (size_t i = 0; i < eProcStore[procId].size(); i++) {
-        GStatsEnergy *e = eProcStore[procId][i];
-
-        e->inc(); // charge unit energy to compute power densities
-        double pwr = EnergyMgr::etop(e->getDouble());
-        ReportTherm::field("%g\t", pwr);
+        names.push_back(eProcStore[procId][i]->name);
     }
-    ReportTherm::field("\n");
-#endif
 }
 
-void GStatsEnergy::printDump(int32_t procId)
+void GStatsEnergy::sampleDump(int32_t procId, double *energy)
 {
     I((uint32_t)procId < eProcStore.size());
 
-    // dump values
+    // Only copy the values, ReportTherm converts them off the simulation thread
     for(size_t i=0; i<eProcStore[procId].size(); i++) {
-        GStatsEnergy *e = eProcStore[procId][i];
-
-        double pwr = EnergyMgr::etop(e->getDouble());
-
-        ReportTherm::fieldRaw(pwr);
+        energy[i] = eProcStore[procId][i]->getDouble();
     }
 }
 
@@ -227,17 +199,6 @@ double GStatsEnergy::getDouble() const
 #endif
 }
 
-void GStatsEnergy::inc()
-{
-    steps++;
-}
-
-void GStatsEnergy::add(int32_t v)
-{
-    I(v >= 0);
-    steps += v;
-}
-
 /*****************************************************
   *           GStatsEnergyCGBase
   ****************************************************/
@@ -250,14 +211,6 @@ GStatsEnergyCGBase::GStatsEnergyCGBase(const char* str,int32_t procId)
     name = strdup(str);
 }
 
-void GStatsEnergyCGBase::use()
-{
-    if(lastCycleUsed != globalClock) {
-        numCycles++;
-        lastCycleUsed = globalClock;
-    }
-}
-
 /*****************************************************
   *           GStatsEnergyCG
   ****************************************************/
@@ -267,9 +220,8 @@ GStatsEnergyCG::GStatsEnergyCG(const char *name,
                                PowerGroup grp,
                                double energy,
                                GStatsEnergyCGBase *b)
-    : GStatsEnergy(name, block, procId, grp, energy)
+    : GStatsEnergy(name, block, procId, grp, energy, b)
 {
-    eb = b;
     localE = energy*0.95;
     clockE = energy*0.05;
 }
@@ -283,19 +235,6 @@ double GStatsEnergyCG::getDouble() const
 #endif
 }
 
-void GStatsEnergyCG::inc()
-{
-    steps++;
-    eb->use();
-}
-
-void GStatsEnergyCG::add(int32_t v)
-{
-    I(v >= 0);
-    steps += v;
-    eb->use();
-}
-
 // Energy Store functions
 EnergyStore::EnergyStore()
 {
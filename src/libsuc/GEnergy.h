@@ -27,6 +27,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <ctype.h>
 
 #include "estl.h"
+#include "Snippets.h"
 #include "GStats.h"
 #include "Config.h"
 #include "SescConf.h"
@@ -142,18 +143,62 @@ public:
     double get(const char *name, int32_t procId=0);
 };
 
+class GStatsEnergyCGBase {
+protected:
+    Time_t lastCycleUsed;
+    int32_t  numCycles;
+    char *name;
+    int32_t   id;
+
+public:
+    int32_t getNumCycles() {
+        return numCycles;
+    }
+    GStatsEnergyCGBase(const char* str,int32_t id);
+
+    void use() {
+        if(lastCycleUsed != globalClock) {
+            numCycles++;
+            lastCycleUsed = globalClock;
+        }
+    }
+};
+
+// Energy counters only count events. The count is turned into energy by
+// getDouble(), which is called when stats are reported or sampled, so the
+// per-event inc() and add() are plain non-virtual increments.
 class GStatsEnergyBase : public GStats {
+protected:
+    long long steps;
+    // Clock-gated block that is also charged for the cycle of each event
+    GStatsEnergyCGBase *eb;
+
 public:
+    GStatsEnergyBase(GStatsEnergyCGBase *b = 0)
+        : steps(0)
+        ,eb(b) {
+    }
     virtual double getDouble() const = 0;
-    virtual void inc() = 0;
-    virtual void add(int32_t v) = 0;
+    void resetValue() {
+        steps = 0;
+    }
+
+    void inc() {
+        steps++;
+        if(eb)
+            eb->use();
+    }
+    void add(int32_t v) {
+        I(v >= 0);
+        steps += v;
+        if(eb)
+            eb->use();
+    }
 };
 
 class GStatsEnergyNull : public GStatsEnergyBase {
 public:
     double getDouble() const;
-    void inc();
-    void add(int32_t v);
 
     void reportValue() const {};
 };
@@ -167,14 +212,13 @@ protected:
     static EGroupStoreType eGroupStore; // Energy store per group
 
     const double  StepEnergy;
-    long long steps;
 
     PowerGroup gid;
 
 public:
     GStatsEnergy(const char *name, const char* block
                  ,int32_t procId, PowerGroup grp
-                 ,double energy);
+                 ,double energy, GStatsEnergyCGBase *b = 0);
     ~GStatsEnergy() {};
     static double getTotalProc(int32_t procId);
     static double getTotalGroup(PowerGroup grp);
@@ -184,8 +228,9 @@ public:
     static double getTotalEnergy();
 
 #ifdef SESC_THERM
-    static void setupDump(int32_t procId);
-    static void printDump(int32_t procId);
+    // Names of procId's counters, and a snapshot of their energy in that order
+    static void setupDump(int32_t procId, std::vector<const char *> &names);
+    static void sampleDump(int32_t procId, double *energy);
 
     void reportValueDump() const;
     void reportValueDumpSetup() const;
@@ -198,29 +243,10 @@ public:
     }
 
     virtual double getDouble() const;
-    virtual void inc();
-    virtual void add(int32_t v);
-};
-
-class GStatsEnergyCGBase {
-protected:
-    Time_t lastCycleUsed;
-    int32_t  numCycles;
-    char *name;
-    int32_t   id;
-
-public:
-    int32_t getNumCycles() {
-        return numCycles;
-    }
-    GStatsEnergyCGBase(const char* str,int32_t id);
-
-    void use();
 };
 
 class GStatsEnergyCG : public GStatsEnergy {
 protected:
-    GStatsEnergyCGBase *eb;
     double localE;
     double clockE;
 
@@ -230,8 +256,6 @@ public:
                    ,double energy, GStatsEnergyCGBase *b);
 
     double getDouble() const;
-    void inc();
-    void add(int32_t v);
 };
 #endif
 
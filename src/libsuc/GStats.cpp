@@ -35,6 +35,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "ReportGen.h"
 
 GStats::Container *GStats::store=0;
+size_t GStats::nHoles=0;
 
 GStats::~GStats()
 {
@@ -223,26 +224,30 @@ void GStats::subscribe()
 {
     if( store == 0 )
         store = new Container;
-    cpos=store->insert(store->end(),this);
+
+    if(nHoles > store->size()/2) {
+        size_t n = 0;
+        for(size_t i = 0; i < store->size(); i++) {
+            GStats *g = (*store)[i];
+            if(g == 0)
+                continue;
+            g->cpos = n;
+            (*store)[n++] = g;
+        }
+        store->resize(n);
+        nHoles = 0;
+    }
+
+    cpos = store->size();
+    store->push_back(this);
 }
 
 void GStats::unsubscribe()
 {
     I(store);
-    I(*cpos==this);
-    store->erase(cpos);
-//   bool found = false;
-//   I(store);
-
-//   for(ContainerIter i = store->begin(); i != store->end(); i++) {
-//     if(*i == this) {
-//       found = true;
-//       store->erase(i);
-//       break;
-//     }
-//   }
-
-//   GMSG(!found, "GStats::unsubscribe It should be in the list");
+    I((*store)[cpos]==this);
+    (*store)[cpos] = 0;
+    nHoles++;
 }
 
 void GStats::report(const char *str)
@@ -250,6 +255,8 @@ void GStats::report(const char *str)
     Report::field("BEGIN GStats::report %s", str);
     if (store) {
         for(ContainerIter i = store->begin(); i != store->end(); i++) {
+            if(*i == 0)
+                continue;
             (*i)->prepareReport(); //give class a chance to do any calculations
             (*i)->reportValue();
         }
@@ -261,7 +268,8 @@ void GStats::report(const char *str)
 void GStats::reset() {
     if (store) {
         for(ContainerIter i = store->begin(); i != store->end(); i++) {
-            (*i)->resetValue();
+            if(*i)
+                (*i)->resetValue();
         }
     }
 }
@@ -272,7 +280,7 @@ GStats *GStats::getRef(const char *str)
 {
     for(ContainerIter i = store->begin(); i != store->end(); i++) {
 
-        if(strcasecmp((*i)->name, str) == 0)
+        if(*i && strcasecmp((*i)->name, str) == 0)
             return *i;
     }
 
@@ -340,8 +348,10 @@ void GStatsMax::reportValue() const
 
 /*********************** GStatsHist */
 
-GStatsHist::GStatsHist(const char *format,...) : numSample(0), cumulative(0)
+GStatsHist::GStatsHist(const char *format,...) : densePresent(0), numSample(0), cumulative(0)
 {
+    memset(dense, 0, sizeof(dense));
+
     char *str;
     va_list ap;
 
@@ -353,13 +363,37 @@ GStatsHist::GStatsHist(const char *format,...) : numSample(0), cumulative(0)
     subscribe();
 }
 
+void GStatsHist::getBins(Bins &bins) const
+{
+    for(uint64_t p = densePresent; p; p &= p - 1) {
+        uint32_t k = __builtin_ctzll(p);
+        bins.push_back(std::make_pair(k, dense[k]));
+    }
+    for(Histogram::const_iterator it = H.begin(); it != H.end(); it++)
+        bins.push_back(*it);
+}
+
+void GStatsHist::clearHist()
+{
+    // Only the part of the array sampled since the last reset can be dirty
+    if(densePresent)
+        memset(dense, 0, (64 - __builtin_clzll(densePresent)) * sizeof(dense[0]));
+    densePresent = 0;
+    if(!H.empty())
+        H.clear();
+
+    numSample = 0;
+    cumulative = 0;
+}
+
 void GStatsHist::reportValue() const
 {
-    Histogram::const_iterator it;
+    Bins bins;
+    getBins(bins);
 
     uint32_t maxKey = 0;
 
-    for(it=H.begin(); it!=H.end(); it++) {
+    for(Bins::const_iterator it=bins.begin(); it!=bins.end(); it++) {
         Report::field("%s(%lu)=%llu",name,(*it).first,(*it).second);
         if((*it).first > maxKey)
             maxKey = (*it).first;
@@ -372,17 +406,6 @@ void GStatsHist::reportValue() const
     Report::field("%s_Samples=%lu",name,numSample);
 }
 
-void GStatsHist::sample(uint32_t key, unsigned long long weight)
-{
-    if(H.find(key)==H.end())
-        H[key]=0;
-
-    H[key]+=weight;
-
-    numSample += weight;
-    cumulative += weight * key;
-}
-
 /*********************** GStatsTimingAvg */
 
 GStatsTimingAvg::GStatsTimingAvg(const char *format,...)
@@ -428,6 +451,7 @@ GStatsTimingHist::GStatsTimingHist(const char *format,...)
     name = str;
     subscribe();
 
+    startClock = 0;
     lastUpdate = 0;
     lastKey = 0;
 
@@ -436,18 +460,22 @@ GStatsTimingHist::GStatsTimingHist(const char *format,...)
 
 void GStatsTimingHist::reportValue() const
 {
-    Histogram::const_iterator it;
+    Bins bins;
+    getBins(bins);
+
     unsigned long long w = 0;
     double wavg = 0;
+    Time_t nCycles = globalClock - startClock;
 
-    for(it=H.begin(); it!=H.end(); it++) {
+    for(Bins::const_iterator it=bins.begin(); it!=bins.end(); it++) {
 
         if((*it).first == lastKey)
             w = globalClock-lastUpdate;
         else
             w = 0;
 
-        wavg += ((*it).first * ((*it).second + w)) / globalClock;
+        if(nCycles)
+            wavg += ((*it).first * ((*it).second + w)) / nCycles;
 
         if(reportWholeHist)
             Report::field("%s(%lu)=%llu",name,(*it).first,(*it).second+w);
@@ -659,9 +687,10 @@ GStatsChangeHist::GStatsChangeHist(const char *format,...)
 
 void GStatsChangeHist::reportValue() const
 {
-    Histogram::const_iterator it;
+    Bins bins;
+    getBins(bins);
 
-    for(it=H.begin(); it!=H.end(); it++)
+    for(Bins::const_iterator it=bins.begin(); it!=bins.end(); it++)
         Report::field("%s(%lu)=%llu",name,(*it).first,(*it).second);
 
 }
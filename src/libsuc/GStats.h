@@ -26,8 +26,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #ifndef GSTATSD_H
 #define GSTATSD_H
 
-#include <list>
 #include <stdarg.h>
+#include <string.h>
 #include <vector>
 #include <set>
 
@@ -49,11 +49,15 @@ struct hash_unsigned_long_long {
 
 class GStats {
 private:
-    typedef std::list < GStats * >Container;
-    typedef std::list < GStats * >::iterator ContainerIter;
+    // Stats in subscription order. Unsubscribing leaves a null hole, so the
+    // others keep their slot; holes are squeezed out once they are the
+    // majority. A vector walks far faster than a list on report and reset.
+    typedef std::vector < GStats * >Container;
+    typedef std::vector < GStats * >::iterator ContainerIter;
     static Container *store;
-    // Points to this GStats object's position in the GStats store
-    ContainerIter cpos;
+    static size_t nHoles;
+    // This GStats object's slot in the GStats store
+    size_t cpos;
 protected:
     char *name;
     char *getText(const char *format,
@@ -253,28 +257,53 @@ protected:
 
     typedef HASH_MAP<uint32_t, unsigned long long> Histogram;
 
+    // Almost every sample (abort types, queue occupancies, NoC latencies)
+    // has a small key, so keys below DenseKeys are counted in a plain
+    // array and only the rest pay for a hash map insert
+    enum { DenseKeys = 64 };
+    unsigned long long dense[DenseKeys];
+    // Dense keys sampled since the last reset, even with zero weight
+    uint64_t densePresent;
+
     unsigned long long numSample;
     unsigned long long cumulative;
 
     Histogram H;
 
+    typedef std::vector< std::pair<uint32_t, unsigned long long> > Bins;
+    // Keys sampled and their weights, the dense keys first and in order
+    void getBins(Bins &bins) const;
+    void clearHist();
+
 public:
     GStatsHist(const char *format,...);
-    GStatsHist() { }
+    GStatsHist() : densePresent(0), numSample(0), cumulative(0) {
+        memset(dense, 0, sizeof(dense));
+    }
 
     void reportValue() const;
     void resetValue() {
-        H.clear();
-        numSample = 0;
-        cumulative = 0;
+        clearHist();
     }
 
 
-    void sample(uint32_t key, unsigned long long weight=1);
+    void sample(uint32_t key, unsigned long long weight=1) {
+        if(key < DenseKeys) {
+            dense[key] += weight;
+            densePresent |= 1ULL << key;
+        } else {
+            H[key] += weight;
+        }
+
+        numSample += weight;
+        cumulative += weight * key;
+    }
 };
 
 class GStatsTimingHist : public GStatsHist {
 private:
+    // Cycle of the last reset, where the current samples begin
+    Time_t startClock;
     Time_t lastUpdate;
     uint32_t lastKey;
     bool reportWholeHist;
@@ -283,13 +312,11 @@ public:
 
     void reportValue() const;
     void resetValue() {
-        H.clear();
-        numSample = 0;
-        cumulative = 0;
+        clearHist();
 
-        lastUpdate = 0;
-        lastKey = 0;
-        reportWholeHist = true;
+        // The current key still holds, from now on
+        startClock = globalClock;
+        lastUpdate = globalClock;
     }
 
 
@@ -310,9 +337,7 @@ public:
     GStatsChangeHist(const char *format,...);
     void reportValue() const;
     void resetValue() {
-        H.clear();
-        numSample = 0;
-        cumulative = 0;
+        clearHist();
 
         lastUpdate = 0;
     }
@@ -360,9 +385,7 @@ public:
 
     void reportValue() const;
     void resetValue() {
-        H.clear();
-        numSample = 0;
-        cumulative = 0;
+        clearHist();
 
         currentSum = 0;
     }
@@ -384,9 +407,7 @@ public:
 
     void reportValue() const;
     void resetValue() {
-        H.clear();
-        numSample = 0;
-        cumulative = 0;
+        clearHist();
     }
     void inc();
 };
@@ -0,0 +1,70 @@
+#ifndef INLINESTACK_H
+#define INLINESTACK_H
+
+#include <vector>
+
+#include "nanassert.h"
+
+// Stack that keeps its first N elements inside the object. Deeper elements
+// spill to a vector, which keeps its capacity across clear(), so a pooled
+// object stops touching the heap once it has seen its deepest use.
+template<class Data, size_t N>
+class InlineStack {
+private:
+    Data   elems[N];
+    size_t nElems;
+
+    std::vector<Data> spill;
+
+public:
+    InlineStack() : nElems(0) {
+    }
+
+    // Hint for the spill area, e.g. the deepest path the configuration allows
+    void reserve(size_t n) {
+        if (n > N)
+            spill.reserve(n - N);
+    }
+
+    void push(const Data &d) {
+        if (nElems < N)
+            elems[nElems] = d;
+        else
+            spill.push_back(d);
+        nElems++;
+    }
+
+    void pop() {
+        I(nElems);
+        nElems--;
+        if (nElems >= N)
+            spill.pop_back();
+    }
+
+    Data &top() {
+        I(nElems);
+        if (nElems > N)
+            return spill.back();
+        return elems[nElems-1];
+    }
+    const Data &top() const {
+        I(nElems);
+        if (nElems > N)
+            return spill.back();
+        return elems[nElems-1];
+    }
+
+    void clear() {
+        nElems = 0;
+        spill.clear();
+    }
+
+    bool empty() const {
+        return nElems == 0;
+    }
+    size_t size() const {
+        return nElems;
+    }
+};
+
+#endif // INLINESTACK_H
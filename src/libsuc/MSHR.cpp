@@ -51,6 +51,8 @@ MSHR<Addr_t, Cache_t> *MSHR<Addr_t, Cache_t>::create(const char *name,
         mshr = new FullMSHR<Addr_t, Cache_t>(name, size, lineSize, aPolicy);
     } else if(strcmp(type, "single") == 0) {
         mshr = new SingleMSHR<Addr_t, Cache_t>(name, size, lineSize, nrd, nwr, aPolicy);
+    } else if(strcmp(type, "array") == 0) {
+        mshr = new ArrayMSHR<Addr_t, Cache_t>(name, size, lineSize, nrd, nwr, aPolicy);
     } else {
         MSG("WARNING:MSHR: type \"%s\" unknown, defaulting to \"none\"", type);
         mshr = new NoMSHR<Addr_t, Cache_t>(name, size, lineSize, aPolicy);
@@ -941,6 +943,309 @@ void SingleMSHR<Addr_t, Cache_t>::putEntry(MSHRentry<Addr_t> &me)
     I(nFreeEntries >=0);
 }
 
+//
+// ArrayMSHR
+//
+
+template<class Addr_t, class Cache_t>
+ArrayMSHR<Addr_t, Cache_t>::ArrayMSHR(const char *name, int32_t size,
+                                      int32_t lineSize, int32_t nrd, int32_t nwr,
+                                      int32_t aPolicy)
+    : MSHR<Addr_t, Cache_t>(name, size, lineSize, aPolicy),
+      nReads(nrd),
+      nWrites(nwr),
+      bf(4, 8, 256, 6, 64, 6, 64, 6, 64),
+      avgOverflowConsumptions("%s_MSHR_avgOverflowConsumptions", name),
+      maxOutsReqs("%s_MSHR_maxOutsReqs", name),
+      avgReqsPerLine("%s_MSHR_avgReqsPerLine", name),
+      nIssuesNewEntry("%s_MSHR:nIssuesNewEntry", name),
+      nCanNotAcceptSubEntryFull("%s_MSHR:nCanNotAcceptSubEntryFull", name),
+      nCanNotAcceptTooManyWrites("%s_MSHR:nCanNotAcceptTooManyWrites", name),
+      avgQueueSize("%s_MSHR_avgQueueSize", name),
+      avgWritesPerLine("%s_MSHR_avgWritesPerLine", name),
+      avgWritesPerLineComb("%s_MSHR_avgWritesPerLineComb", name),
+      nRetiredEntries("%s_MSHR:nRetiredEntries", name),
+      nRetiredEntriesWritten("%s_MSHR:nRetiredEntriesWritten", name),
+      nLookups("%s_MSHR:nLookups", name),
+      nLookupsFiltered("%s_MSHR:nLookupsFiltered", name)
+{
+    tags     = new Addr_t[nEntries];
+    entry    = new MSHRentry<Addr_t>[nEntries];
+    freeList = new int32_t[nEntries];
+
+    for(int32_t i = 0; i < nEntries; i++) {
+        tags[i] = NoTag;
+        freeList[i] = nEntries - 1 - i;
+    }
+
+    nFreeEntries = nEntries;
+    nFullReadEntries = 0;
+    nFullWriteEntries = 0;
+    checkingOverflow = false;
+    nOutsReqs = 0;
+}
+
+template<class Addr_t, class Cache_t>
+int32_t ArrayMSHR<Addr_t, Cache_t>::allocEntry(Addr_t paddr, MemOperation mo)
+{
+    I(nFreeEntries > 0);
+
+    Addr_t lineAddr = this->calcLineAddr(paddr);
+    int32_t e = freeList[--nFreeEntries];
+    I(tags[e] == NoTag);
+
+    tags[e] = lineAddr;
+    entry[e] = MSHRentry<Addr_t>();
+    entry[e].firstRequest(paddr, lineAddr, nReads, nWrites, mo);
+    bf.insert(lineAddr);
+
+#ifdef MSHR_BASICOCCSTATS
+    updateOccHistogram();
+    if(mo == MemRead)
+        occStats->incRdReqs();
+#endif
+
+    nOutsReqs++;
+    nIssuesNewEntry.inc();
+    avgQueueSize.sample(0);
+
+    checkSubEntries(e, mo);
+
+    return e;
+}
+
+template<class Addr_t, class Cache_t>
+bool ArrayMSHR<Addr_t, Cache_t>::issue(Addr_t paddr, MemOperation mo)
+{
+    nUse.inc();
+    if(mo == MemRead)
+        nUseReads.inc();
+
+    if(mo == MemWrite)
+        nUseWrites.inc();
+
+    if(!overflow.empty())
+        return false;
+
+    I(nFreeEntries >= 0 && nFreeEntries <= nEntries);
+
+    if(nFreeEntries == 0 || findEntry(this->calcLineAddr(paddr)) >= 0)
+        return false;
+
+    allocEntry(paddr, mo);
+    return true;
+}
+
+template<class Addr_t, class Cache_t>
+void ArrayMSHR<Addr_t, Cache_t>::toOverflow(Addr_t paddr, CallbackBase *c,
+        CallbackBase *ovflwc, MemOperation mo)
+{
+    OverflowField f;
+    f.paddr = paddr;
+    f.cb    = c;
+    f.ovflwcb = ovflwc;
+    f.mo      = mo;
+
+    overflow.push_back(f);
+    nOverflows.inc();
+}
+
+template<class Addr_t, class Cache_t>
+void ArrayMSHR<Addr_t, Cache_t>::checkSubEntries(int32_t e, MemOperation mo)
+{
+    if(entry[e].isRdWrSharing()) {
+        if(!entry[e].hasFreeReads() || !entry[e].hasFreeWrites()) {
+            nFullReadEntries++;
+            nFullWriteEntries++;
+        }
+    } else {
+        if(!entry[e].hasFreeReads() && mo == MemRead)
+            nFullReadEntries++;
+        if(!entry[e].hasFreeWrites() && mo == MemWrite)
+            nFullWriteEntries++;
+    }
+}
+
+template<class Addr_t, class Cache_t>
+void ArrayMSHR<Addr_t, Cache_t>::checkOverflow()
+{
+    if(overflow.empty() || checkingOverflow)
+        return;
+
+    checkingOverflow = true;
+
+    int32_t nConsumed = 0;
+
+    do {
+        OverflowField f = overflow.front();
+        int32_t e = findEntry(this->calcLineAddr(f.paddr));
+
+        if(e < 0) {
+            if(nFreeEntries == 0)
+                break;
+
+            allocEntry(f.paddr, f.mo);
+            nConsumed++;
+
+            f.ovflwcb->call();
+            f.cb->destroy();
+            overflow.pop_front();
+        } else {
+            // the line is already pending, just try to add the request
+            if(!entry[e].addRequest(f.paddr, f.cb, f.mo))
+                break;
+
+            avgQueueSize.sample(entry[e].getPendingReqs() - 1);
+            f.ovflwcb->destroy();
+            overflow.pop_front();
+            nOutsReqs++;
+
+#ifdef MSHR_BASICOCCSTATS
+            if(f.mo == MemRead)
+                occStats->incRdReqs();
+#endif
+
+            checkSubEntries(e, f.mo);
+        }
+    } while(!overflow.empty());
+
+    if(nConsumed)
+        avgOverflowConsumptions.sample(nConsumed);
+
+    checkingOverflow = false;
+}
+
+template<class Addr_t, class Cache_t>
+void ArrayMSHR<Addr_t, Cache_t>::addEntry(Addr_t paddr, CallbackBase *c,
+        CallbackBase *ovflwc, MemOperation mo)
+{
+    I(ovflwc); // as in SingleMSHR, overflow handler REQUIRED!
+
+    if(!overflow.empty()) {
+        toOverflow(paddr, c, ovflwc, mo);
+        return;
+    }
+
+    int32_t e = findEntry(this->calcLineAddr(paddr));
+
+    // no entry means the issue did not happen, or too many oustanding
+    // requests to the same line already. Either way, send to overflow
+    if(e < 0 || !entry[e].addRequest(paddr, c, mo)) {
+        toOverflow(paddr, c, ovflwc, mo);
+        return;
+    }
+
+    avgQueueSize.sample(entry[e].getPendingReqs() - 1);
+    nOutsReqs++;
+
+#ifdef MSHR_BASICOCCSTATS
+    if(mo == MemRead)
+        occStats->incRdReqs();
+#endif
+
+    // there was no overflow, so the callback needs to be destroyed
+    ovflwc->destroy();
+    checkSubEntries(e, mo);
+}
+
+template<class Addr_t, class Cache_t>
+bool ArrayMSHR<Addr_t, Cache_t>::retire(Addr_t paddr)
+{
+    int32_t e = findEntry(this->calcLineAddr(paddr));
+    I(e >= 0);
+
+    maxOutsReqs.sample(nOutsReqs);
+    nOutsReqs--;
+
+    MSHRentry<Addr_t> &me = entry[e];
+    bool rmEntry = me.retire();
+    if(rmEntry) {
+        // the last pending request for the entry was completed, recycle it
+        nRetiredEntries.inc();
+        avgReqsPerLine.sample(me.getUsedReads() + me.getUsedWrites());
+        maxUsedEntries.sample(nEntries - nFreeEntries);
+        avgWritesPerLine.sample(me.getUsedWrites());
+        avgWritesPerLineComb.sample(me.getNWrittenWords());
+
+        if(me.getUsedWrites() > 0)
+            nRetiredEntriesWritten.inc();
+
+        if(!me.hasFreeReads()) {
+            nFullReadEntries--;
+            I(nFullReadEntries>=0);
+        }
+
+        if(!me.hasFreeWrites()) {
+            nFullWriteEntries--;
+            I(nFullWriteEntries>=0);
+        }
+
+#ifdef MSHR_BASICOCCSTATS
+        occStats->decRdReqs(me.getUsedReads());
+        if(me.isL2Hit())
+            occStats->avgReadSubentriesL2Hit.sample(me.getUsedReads());
+        else
+            occStats->avgReadSubentriesL2Miss.sample(me.getUsedReads());
+#endif
+
+        bf.remove(tags[e]);
+        tags[e] = NoTag;
+        freeList[nFreeEntries++] = e;
+
+#ifdef MSHR_BASICOCCSTATS
+        updateOccHistogram();
+#endif
+    }
+
+    checkOverflow();
+
+    return rmEntry;
+}
+
+template<class Addr_t, class Cache_t>
+bool ArrayMSHR<Addr_t, Cache_t>::canAcceptRequestSpecial(Addr_t paddr, MemOperation mo)
+{
+    if(!overflow.empty()) {
+        nCanNotAccept.inc();
+        return false;
+    }
+
+    I(nFreeEntries >= 0 && nFreeEntries <= nEntries);
+
+    int32_t e = findEntry(this->calcLineAddr(paddr));
+    if(e < 0) {
+        if(nFreeEntries <= 0) {
+            nCanNotAccept.inc();
+            return false;
+        }
+        nCanAccept.inc();
+        return true;
+    }
+
+    bool canAccept = entry[e].canAcceptRequest(mo);
+    if(canAccept)
+        nCanAccept.inc();
+    else {
+        nCanNotAccept.inc();
+
+        if(mo == MemWrite && !entry[e].hasFreeWrites())
+            nCanNotAcceptTooManyWrites.inc();
+        else
+            nCanNotAcceptSubEntryFull.inc();
+    }
+
+    return canAccept;
+}
+
+template<class Addr_t, class Cache_t>
+bool ArrayMSHR<Addr_t, Cache_t>::isOnlyWrites(Addr_t paddr)
+{
+    int32_t e = findEntry(this->calcLineAddr(paddr));
+    I(e >= 0);
+
+    return (entry[e].getUsedReads() == 0);
+}
+
 //
 // BankedMSHR
 //
@@ -1215,8 +1520,7 @@ bool MSHRentry<Addr_t>::addRequest(Addr_t reqAddr, CallbackBase *rcb, MemOperati
         nFreeReads--;
     } else {
         I(mo == MemWrite);
-        //hardcoded word mask for now. ugly, i know.
-        writeSet.insert(reqAddr & 0xfffffffc);
+        markWritten(reqAddr);
         nFreeWrites--;
     }
 
@@ -221,6 +221,9 @@ public:
     int32_t getnEntries() const {
         return nEntries;
     }
+    int32_t getnFreeEntries() const {
+        return nFreeEntries;
+    }
 
     virtual int32_t  getnReads() const {
         return 1;
@@ -469,7 +472,14 @@ private:
 
     bool l2Hit;
 
-    HASH_SET<PAddr> writeSet;
+    // One bit per word written, indexed by the word within the line (exact
+    // for lines of up to 256 bytes). Entries are recycled on every miss, so
+    // a mask replaces the set of word addresses that had to allocate.
+    uint64_t writtenWords;
+
+    void markWritten(Addr_t addr) {
+        writtenWords |= 1ULL << ((addr >> 2) & 63);
+    }
 
 public:
     MSHRentry() {
@@ -481,7 +491,7 @@ public:
         displaced = false;
         whenAllocated = globalClock;
         l2Hit = false;
-        writeSet.clear();
+        writtenWords = 0;
     }
 
     ~MSHRentry() {
@@ -521,7 +531,7 @@ public:
 
         if(mo == MemWrite) {
             nFreeWrites--;
-            writeSet.insert(addr & 0xfffffffc);
+            markWritten(addr);
         } else {
             I(mo == MemRead);
             nFreeReads--;
@@ -550,7 +560,7 @@ public:
     }
 
     int32_t getNWrittenWords() const {
-        return writeSet.size();
+        return __builtin_popcountll(writtenWords);
     }
     int32_t getUsedWrites()    const {
         return (nWrites - nFreeWrites);
@@ -737,6 +747,155 @@ public:
     }
 };
 
+//
+// ArrayMSHR: behaves like SingleMSHR (per line entries with read and write
+// subentries, and an overflow queue), but keeps its entries in fixed arrays
+// sized at construction. Every lookup first asks the bloom filter, and only
+// when the line may be present scans the tag array, which is small enough
+// for a linear search to beat the hash map. Requests waiting on an entry are
+// chained in its CallbackContainer, so a miss never allocates memory.
+//
+
+template<class Addr_t, class Cache_t>
+class ArrayMSHR : public MSHR<Addr_t, Cache_t> {
+    using MSHR<Addr_t, Cache_t>::nEntries;
+    using MSHR<Addr_t, Cache_t>::nFreeEntries;
+    using MSHR<Addr_t, Cache_t>::Log2LineSize;
+    using MSHR<Addr_t, Cache_t>::nUse;
+    using MSHR<Addr_t, Cache_t>::nUseReads;
+    using MSHR<Addr_t, Cache_t>::nUseWrites;
+    using MSHR<Addr_t, Cache_t>::nOverflows;
+    using MSHR<Addr_t, Cache_t>::maxUsedEntries;
+    using MSHR<Addr_t, Cache_t>::nCanAccept;
+    using MSHR<Addr_t, Cache_t>::nCanNotAccept;
+    using MSHR<Addr_t, Cache_t>::updateOccHistogram;
+    using MSHR<Addr_t, Cache_t>::lowerCache;
+    using MSHR<Addr_t, Cache_t>::occStats;
+
+private:
+    const int32_t nReads;
+    const int32_t nWrites;
+    int32_t nOutsReqs;
+    BloomFilter bf;
+
+    bool checkingOverflow;
+
+    int32_t nFullReadEntries;
+    int32_t nFullWriteEntries;
+
+    typedef OverflowFieldT<Addr_t> OverflowField;
+    typedef std::deque<OverflowField> Overflow;
+    Overflow overflow;
+
+    // tags[i] is the line held by entry[i], or NoTag when the entry is free.
+    // The free entries are stacked in freeList[0..nFreeEntries-1].
+    static const Addr_t NoTag = (Addr_t)-1;
+    Addr_t            *tags;
+    MSHRentry<Addr_t> *entry;
+    int32_t           *freeList;
+
+    GStatsAvg avgOverflowConsumptions;
+    GStatsMax maxOutsReqs;
+    GStatsAvg avgReqsPerLine;
+    GStatsCntr nIssuesNewEntry;
+    GStatsCntr nCanNotAcceptSubEntryFull;
+    GStatsCntr nCanNotAcceptTooManyWrites;
+    GStatsAvg  avgQueueSize;
+    GStatsAvg  avgWritesPerLine;
+    GStatsAvg  avgWritesPerLineComb;
+    GStatsCntr nRetiredEntries;
+    GStatsCntr nRetiredEntriesWritten;
+    GStatsCntr nLookups;
+    GStatsCntr nLookupsFiltered;
+
+    // Index of the entry for lineAddr, or -1 if there is none
+    int32_t findEntry(Addr_t lineAddr) {
+        nLookups.inc();
+        if(!bf.mayExist(lineAddr)) {
+            nLookupsFiltered.inc();
+            return -1;
+        }
+        for(int32_t i = 0; i < nEntries; i++) {
+            if(tags[i] == lineAddr)
+                return i;
+        }
+        return -1;
+    }
+
+    int32_t allocEntry(Addr_t paddr, MemOperation mo);
+
+    void toOverflow(Addr_t paddr, CallbackBase *c, CallbackBase *ovflwc,
+                    MemOperation mo);
+
+    void checkOverflow();
+
+    void checkSubEntries(int32_t e, MemOperation mo);
+
+protected:
+    friend class MSHR<Addr_t, Cache_t>;
+    ArrayMSHR(const char *name, int32_t size, int32_t lineSize,
+              int32_t nrd = 16, int32_t nwr = 16, int32_t aPolicy = SPECIAL);
+
+public:
+    virtual ~ArrayMSHR() {
+        delete [] tags;
+        delete [] entry;
+        delete [] freeList;
+    }
+
+    bool canAcceptRequestSpecial(Addr_t paddr, MemOperation mo = MemRead);
+    bool isOnlyWrites(Addr_t paddr);
+
+    bool issue(Addr_t paddr, MemOperation mo = MemRead);
+
+    void addEntry(Addr_t paddr, CallbackBase *c,
+                  CallbackBase *ovflwc = 0, MemOperation mo = MemRead);
+
+    bool retire(Addr_t paddr);
+
+    int32_t getnReads() const {
+        return nReads;
+    }
+    int32_t getnWrites() const {
+        return nWrites;
+    }
+
+    int32_t getUsedReads(Addr_t paddr) {
+        int32_t e = findEntry(this->calcLineAddr(paddr));
+        I(e >= 0);
+
+        return entry[e].getUsedReads();
+    }
+
+    int32_t getUsedWrites(Addr_t paddr) {
+        int32_t e = findEntry(this->calcLineAddr(paddr));
+        I(e >= 0);
+
+        return entry[e].getUsedWrites();
+    }
+
+    bool canAllocateEntry() {
+        return (nFreeEntries > 0) && (nFullReadEntries==0) && (nFullWriteEntries==0);
+    }
+    bool readSEntryFull() {
+        return (nFullReadEntries != 0);
+    }
+    bool writeSEntryFull() {
+        return (nFullWriteEntries != 0);
+    }
+
+    void setLowerCache(Cache_t *lCache) {
+        lowerCache = lCache;
+    }
+    bool hasLineReq(Addr_t paddr)  {
+        return (findEntry(paddr) >= 0);
+    }
+
+    bool isOverflowing() {
+        return (overflow.size() > 0);
+    }
+};
+
 //
 // BankedMSHR
 //
@@ -41,6 +41,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "nanassert.h"
 #include "ReportTherm.h"
+#include "ThermSampler.h"
 #include "GProcessor.h"
 #include "OSSim.h"
 #include "GEnergy.h"
@@ -52,6 +53,8 @@ FILE *ReportTherm::rfd[MAXREPORTSTACK];
 int32_t ReportTherm::cyclesPerSample=0; //number of cycles between stats/thermal dumps
 int32_t ReportTherm::tos=0;
 int32_t ReportTherm::rep=0;
+ThermSampler *ReportTherm::sampler=0;
+int32_t ReportTherm::sampleBuffer=64;
 
 StaticCallbackFunction0<ReportTherm::report> ReportTherm::reportCB;
 
@@ -66,13 +69,17 @@ ReportTherm::ReportTherm()
 void ReportTherm::report()
 {
     if (rep == 0) {
-        GStatsEnergy::setupDump(0);
-        ReportTherm::flush();
+        std::vector<const char *> names;
+        GStatsEnergy::setupDump(0, names);
+        // Power per floorplan unit if there is a floorplan, else per counter
+        bool useFloorplan = SescConf->checkCharPtr("","floorplan");
+        sampler = new ThermSampler(rfd[tos-1], names, osSim->getFrequency()/1e9,
+                                   useFloorplan, sampleBuffer);
         rep = 1;
     }
 
-    GStatsEnergy::printDump(0);
-    ReportTherm::flush();
+    GStatsEnergy::sampleDump(0, sampler->getSlot());
+    sampler->commitSlot(globalClock);
 
     if (rep == 1)
         reportCB.schedule(ReportTherm::cyclesPerSample); //Schedule dumps every so many cycles
@@ -109,11 +116,20 @@ void ReportTherm::openFile(char *name)
     const char *model = SescConf->getCharPtr("thermal","model");
     cyclesPerSample   = SescConf->getInt(model,"cyclesPerSample");
     SescConf->isBetween(model,"cyclesPerSample", 100, 1e6);
+    if (SescConf->checkInt(model,"sampleBuffer")) {
+        sampleBuffer = SescConf->getInt(model,"sampleBuffer");
+        SescConf->isGT(model,"sampleBuffer", 0);
+    }
 }
 
 void ReportTherm::close()
 {
     rep = 2;
+    if (sampler) {
+        // Drain the pending samples before the file goes away
+        delete sampler;
+        sampler = 0;
+    }
     while( tos ) {
         printf(".");
         tos--;
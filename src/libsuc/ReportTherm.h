@@ -29,6 +29,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <stdlib.h>
 #include "callback.h"
 
+class ThermSampler;
+
 class ReportTherm {
 private:
     static const int32_t MAXREPORTSTACK = 32;
@@ -38,6 +40,9 @@ private:
     static int32_t rep;
     static FILE *createTmp(const char *name);
     static int32_t cyclesPerSample;
+    // Converts and writes the samples on a background thread
+    static ThermSampler *sampler;
+    static int32_t sampleBuffer;
     ReportTherm();
 public:
     // Creates a new report file. Notice that if the name has the syntax
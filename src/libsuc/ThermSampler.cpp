@@ -0,0 +1,136 @@
+#include <stdlib.h>
+
+#include "ThermSampler.h"
+
+ThermSampler::ThermSampler(FILE *f, const ThermTrace::TokenVectorType &variables
+                           ,double cpns, bool useFloorplan, size_t nSlots)
+    : fd(f)
+    , nVars(variables.size())
+    , cyclesPerNs(cpns)
+    , trace(0)
+    , lastClock(0)
+    , lastEnergy(variables.size(), 0.0)
+    , power(variables.size(), 0.0)
+    , ring(nSlots)
+    , head(0)
+    , tail(0)
+    , nFull(0)
+    , done(false)
+{
+    I(nSlots > 0);
+    for(size_t i = 0; i < ring.size(); i++) {
+        ring[i].clock = 0;
+        ring[i].energy.resize(nVars);
+    }
+
+    if(useFloorplan) {
+        // Mapping the variables to blocks is done once, here
+        trace = new ThermTrace(variables);
+        for(size_t i = 0; i < trace->get_energy_size(); i++) {
+            names.push_back(trace->get_name(i));
+        }
+    } else {
+        names = variables;
+    }
+    record.resize(names.size());
+
+    writer = std::thread(&ThermSampler::writerLoop, this);
+}
+
+ThermSampler::~ThermSampler()
+{
+    close();
+    delete trace;
+}
+
+double *ThermSampler::getSlot()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cvFree.wait(lock, [this] { return nFull < ring.size(); });
+    return ring[head].energy.data();
+}
+
+void ThermSampler::commitSlot(Time_t clock)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ring[head].clock = clock;
+        head = (head + 1) % ring.size();
+        nFull++;
+    }
+    cvFull.notify_one();
+}
+
+void ThermSampler::writeHeader()
+{
+    for(size_t i = 0; i < names.size(); i++) {
+        fprintf(fd, "%s\t", names[i]);
+    }
+    fprintf(fd, "\n");
+}
+
+///
+// Convert one sample to the power of the interval since the previous one
+void ThermSampler::writeSample(const Sample &s)
+{
+    Time_t cycles = s.clock - lastClock;
+    if(cycles == 0) {
+        return;
+    }
+
+    for(size_t i = 0; i < nVars; i++) {
+        power[i] = static_cast<float>((s.energy[i] - lastEnergy[i]) / cycles * cyclesPerNs);
+        lastEnergy[i] = s.energy[i];
+    }
+    lastClock = s.clock;
+
+    if(trace) {
+        trace->map_energy(power.data());
+        for(size_t i = 0; i < record.size(); i++) {
+            record[i] = trace->get_energy(i);
+        }
+        fwrite(record.data(), sizeof(float), record.size(), fd);
+    } else {
+        fwrite(power.data(), sizeof(float), power.size(), fd);
+    }
+}
+
+void ThermSampler::writerLoop()
+{
+    writeHeader();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true) {
+        cvFull.wait(lock, [this] { return done || nFull > 0; });
+        if(nFull == 0) {
+            // done and drained
+            break;
+        }
+
+        // The simulator does not touch a slot until it is released below
+        size_t slot = tail;
+        lock.unlock();
+        writeSample(ring[slot]);
+        lock.lock();
+
+        tail = (tail + 1) % ring.size();
+        nFull--;
+        cvFree.notify_one();
+    }
+    lock.unlock();
+
+    fflush(fd);
+}
+
+void ThermSampler::close()
+{
+    if(!writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+    }
+    cvFull.notify_one();
+    writer.join();
+}
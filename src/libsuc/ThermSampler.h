@@ -0,0 +1,79 @@
+#ifndef THERMSAMPLER_H
+#define THERMSAMPLER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Snippets.h"
+#include "ThermTrace.h"
+
+///
+// Producer/consumer pipeline for power samples. The simulation thread only
+// copies the cumulative energy of each variable into a ring buffer slot; a
+// background thread turns consecutive samples into the average power of the
+// interval, optionally spreads it over the floorplan units, and writes it out.
+//
+// The trace is a tab-separated header line with one name per column, followed
+// by one record of float32 power values per column for every sample.
+class ThermSampler {
+public:
+    // Power is computed as in EnergyMgr::etop, with cyclesPerNs the clock in
+    // GHz. With useFloorplan the columns are the "floorplan" section units.
+    ThermSampler(FILE *fd, const ThermTrace::TokenVectorType &variables
+                 ,double cyclesPerNs, bool useFloorplan, size_t nSlots = 64);
+    ~ThermSampler();
+
+    size_t getNumVariables() const {
+        return nVars;
+    }
+
+    // Slot to fill with one cumulative energy per variable. Blocks only if
+    // the background thread has fallen nSlots samples behind.
+    double *getSlot();
+    void commitSlot(Time_t clock);
+
+    // Write out every committed sample and stop the background thread
+    void close();
+
+private:
+    struct Sample {
+        Time_t clock;
+        std::vector<double> energy;
+    };
+
+    void writerLoop();
+    void writeHeader();
+    void writeSample(const Sample &s);
+
+    FILE        *fd;
+    size_t      nVars;
+    double      cyclesPerNs;
+    ThermTrace  *trace;
+    // Column names of the trace
+    ThermTrace::TokenVectorType names;
+
+    // Consumer-only state
+    Time_t              lastClock;
+    std::vector<double> lastEnergy;
+    std::vector<float>  power;
+    std::vector<float>  record;
+
+    // Ring of samples; head is filled by the simulator, tail drained by the
+    // writer. Protected by mtx.
+    std::vector<Sample>     ring;
+    size_t                  head;
+    size_t                  tail;
+    size_t                  nFull;
+    bool                    done;
+    std::mutex              mtx;
+    std::condition_variable cvFull;
+    std::condition_variable cvFree;
+
+    std::thread             writer;
+};
+
+#endif // THERMSAMPLER_H
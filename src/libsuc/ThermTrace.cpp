@@ -204,6 +204,18 @@ ThermTrace::ThermTrace(const char *input_file)
     read_floorplan_mapping();
 }
 
+ThermTrace::ThermTrace(const TokenVectorType &variables)
+    : input_file_(strdup(""))
+    , input_fd_(-1) {
+
+    mapping.resize(variables.size());
+    for(size_t j=0; j<variables.size(); j++) {
+        mapping[j].name = strdup(variables[j]);
+    }
+
+    read_floorplan_mapping();
+}
+
 void ThermTrace::dump() const {
 
     for(size_t i=0; i<flp.size(); i++) {
@@ -229,7 +241,13 @@ bool ThermTrace::read_energy() {
     if (s != (int)(sizeof(float)*mapping.size()))
         return false;
 
-    // Do mapping
+    map_energy(buffer);
+
+    return true;
+}
+
+void ThermTrace::map_energy(const float *buffer) {
+
     for(size_t k=0; k<flp.size(); k++) {
         flp[k]->energy = 0;
     }
@@ -259,5 +277,4 @@ bool ThermTrace::read_energy() {
     printf("]\n");
 #endif
 
-    return true;
 }
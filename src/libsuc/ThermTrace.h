@@ -71,12 +71,16 @@ private:
 protected:
 public:
     ThermTrace(const char *input_file);
+    // Map the given sesc variables directly, without an input file
+    ThermTrace(const TokenVectorType &variables);
 
     bool is_ready() const {
         return input_fd_>=0;
     }
 
     bool read_energy();
+    // Spread one value per sesc variable over the floorplan units
+    void map_energy(const float *buffer);
 
     float get_energy(size_t pos) const {
         I(pos < flp.size());
@@ -85,6 +89,10 @@ public:
     size_t get_energy_size() const {
         return flp.size();
     }
+    const char *get_name(size_t pos) const {
+        I(pos < flp.size());
+        return flp[pos]->name;
+    }
 
     const FLPUnit *findBlock(const char *name) const;
 